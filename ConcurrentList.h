@@ -0,0 +1,524 @@
+/*-- ConcurrentList.h -----------------------------------------------------
+
+This header file defines the ConcurrentList class, a lock-free singly
+linked list on ConcurrentNodePool that many threads can read and update
+at once. It follows Harris: a node is deleted logically by setting a mark
+bit in its own next link, which freezes that link, and physically by a
+compare-and-swap that swings its predecessor's link past it. Every update
+is a compare-and-swap on one link, so readers never lock.
+Unlinked nodes are reclaimed with epoch-based reclamation. Each thread
+works through a Handle that announces the global epoch while an operation
+runs and keeps the nodes it unlinked in per-epoch limbo lists; a node goes
+back to the pool only once every thread has moved two epochs past the one
+in which it was unlinked, so no thread can still be looking at it and a
+reused index can never be confused with the node it replaced (no ABA on
+the links). A Handle destroyed before its nodes are old enough leaves them
+to the list as orphans, freed by a later epoch advance or by the list's
+destructor, so destroying a Handle never waits for other threads.
+Elements are immutable once inserted. Positions returned by a Handle stay
+valid while the Handle is pinned (see Handle::Pin); outside a pin the node
+may be reclaimed at any time.
+  Basic operations are:
+     Constructor:        Initializes an empty list with a fixed capacity.
+     Destructor:         Releases the list once no Handle remains.
+     Handle:             Per-thread access point for every operation:
+       Pin:              Keeps positions valid across several operations.
+       insertFront:      Inserts an element at the front of the list.
+       insertAfter:      Inserts an element after a given position.
+       insertSorted:     Inserts an element in sorted order.
+       deleteAfter:      Deletes the element after a live position.
+       remove:           Removes a node by its value.
+       find:             Finds a node by its value.
+       contains:         Checks if a value is in the list.
+       value:            Accessor to the element at a position.
+       forEach:          Applies a callable to each element in order.
+       size:             Counts the elements in the list.
+-------------------------------------------------------------------------*/
+
+#ifndef CONCURRENTLIST_H
+#define CONCURRENTLIST_H
+
+#include "ConcurrentNodePool.h"
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+template<typename T, int NUM_NODES = 2048,
+         typename IndexType = typename SmallestIndex<NUM_NODES>::type>
+class ConcurrentList {
+public:
+    // CNode is the pool element: an immutable element and its marked link
+    struct CNode {
+        const T value;              // The element
+        atomic<uint64_t> next;      // Next node in the low 32 bits, deletion mark above
+
+        template<typename... Args>
+        CNode(in_place_t, Args&&... args) : value(std::forward<Args>(args)...), next(0) {}
+    };
+
+    typedef ConcurrentNodePool<CNode, NUM_NODES, IndexType> PoolType;
+    typedef IndexType Index;
+    static const IndexType NULL_VALUE = PoolType::NULL_VALUE;
+    static const int MAX_THREADS = 64;     // Handles that can exist at once
+    static const int RETIRE_BATCH = 64;    // Retired nodes between epoch advance attempts
+
+    /***** Handle *****/
+    class Handle {
+    /*----------------------------------------------------------------------
+      A thread's access point to the list: its epoch slot, its limbo lists
+      and a Magazine it allocates from. Every operation is lock-free. A
+      Handle must only be used by one thread and must be destroyed before
+      the list; its destructor frees the nodes it unlinked that are old
+      enough and hands the rest to the list as orphans, without waiting.
+    ----------------------------------------------------------------------*/
+    public:
+        explicit Handle(ConcurrentList& list);
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle();
+
+        /***** Pin *****/
+        class Pin {
+        /*------------------------------------------------------------------
+          Holds the Handle inside one epoch for its lifetime, so positions
+          obtained meanwhile can be passed to later operations. Keep pins
+          short: a pinned thread holds back reclamation for every thread.
+        ------------------------------------------------------------------*/
+        public:
+            explicit Pin(Handle& handle) : handle(handle) { handle.enter(); }
+            Pin(const Pin&) = delete;
+            Pin& operator=(const Pin&) = delete;
+            ~Pin() { handle.exit(); }
+
+        private:
+            Handle& handle;   // Handle held in its epoch
+        };
+
+        IndexType insertFront(const T& item) { Pin pin(*this); return list.insertFront(*this, item); }
+        IndexType insertAfter(IndexType pos, const T& item) { Pin pin(*this); return list.insertAfter(*this, pos, item); }
+        IndexType insertSorted(const T& item) { Pin pin(*this); return list.insertSorted(*this, item); }
+        bool deleteAfter(IndexType pos) { Pin pin(*this); return list.deleteAfter(*this, pos); }
+        bool remove(const T& item) { Pin pin(*this); return list.remove(*this, item); }
+        IndexType find(const T& item) { Pin pin(*this); return list.find(item); }
+        bool contains(const T& item) { return find(item) != NULL_VALUE; }
+        const T& value(IndexType pos) const { return list.pool.value(pos).value; }
+        template<typename F>
+        void forEach(F&& visit) { Pin pin(*this); list.forEach(visit); }
+        int size() { int n = 0; forEach([&n](const T&) { ++n; }); return n; }
+
+    private:
+        friend class ConcurrentList;
+
+        void enter();
+        void exit();
+        void retire(IndexType idx);
+        void reclaim(vector<IndexType>& limbo);
+
+        ConcurrentList& list;                 // List this handle works on
+        typename PoolType::Magazine magazine; // Per-thread node cache
+        int slot;                             // Index of this handle's epoch slot
+        int depth;                            // Nesting depth of pins
+        uint64_t localEpoch;                  // Epoch announced by the current pin
+        vector<IndexType> limbo[3];           // Unlinked nodes, by epoch modulo 3
+        int retiredSinceAdvance;              // Retires since the last advance attempt
+    };
+
+    /***** Function Members ******/
+
+    /***** Constructor *****/
+    explicit ConcurrentList(int capacity = NUM_NODES);
+    /*----------------------------------------------------------------------
+      Constructor for the ConcurrentList class.
+      Precondition:  0 < capacity <= PoolType::MAX_CAPACITY.
+      Postcondition: An empty list whose pool holds capacity nodes. Nodes
+                     waiting in limbo count against the capacity.
+    ----------------------------------------------------------------------*/
+
+    ConcurrentList(const ConcurrentList&) = delete;
+    ConcurrentList& operator=(const ConcurrentList&) = delete;
+
+    /***** Destructor *****/
+    ~ConcurrentList();
+    /*----------------------------------------------------------------------
+      Destructor for the ConcurrentList class.
+      Precondition:  Every Handle on the list has been destroyed.
+      Postcondition: All elements are destroyed, orphans included.
+    ----------------------------------------------------------------------*/
+
+private:
+    // Operations behind the Handle; each runs inside the handle's pin
+    template<typename... Args>
+    IndexType allocNode(Handle& h, Args&&... args);
+    IndexType insertFront(Handle& h, const T& item);
+    IndexType insertAfter(Handle& h, IndexType pos, const T& item);
+    IndexType insertSorted(Handle& h, const T& item);
+    bool deleteAfter(Handle& h, IndexType pos);
+    bool remove(Handle& h, const T& item);
+    IndexType find(const T& item) const;
+    template<typename F>
+    void forEach(F& visit) const;
+
+    /***** locate *****/
+    template<typename Stop>
+    void locate(Handle& h, Stop stop, atomic<uint64_t>*& predLink, IndexType& curr);
+    /*----------------------------------------------------------------------
+      Walks the list from the head, unlinking and retiring every marked
+      node it meets, until stop(node) holds for an unmarked node.
+      Precondition:  h is pinned.
+      Postcondition: curr is that node (NULL_VALUE if none) and predLink
+                     the link that pointed at it, unmarked, when last read.
+    ----------------------------------------------------------------------*/
+
+    /***** tryAdvance *****/
+    void tryAdvance();
+    /*----------------------------------------------------------------------
+      Moves the global epoch on by one if every pinned handle has already
+      announced the current epoch, then reclaims the orphans that became
+      old enough.
+    ----------------------------------------------------------------------*/
+
+    // Orphans holds the unlinked nodes of a destroyed handle until they
+    // are three epochs older than the handle's last epoch
+    struct Orphans {
+        uint64_t epoch;           // Last epoch of the handle that unlinked them
+        vector<IndexType> nodes;  // Unlinked nodes still waiting to be freed
+        Orphans* next;            // Next batch on the orphan stack
+    };
+
+    /***** adoptOrphans *****/
+    void adoptOrphans(Orphans* batch);
+    /*----------------------------------------------------------------------
+      Pushes a batch of orphans onto the list's lock-free orphan stack.
+    ----------------------------------------------------------------------*/
+
+    /***** reclaimOrphans *****/
+    void reclaimOrphans();
+    /*----------------------------------------------------------------------
+      Takes the whole orphan stack, frees the batches that are three
+      epochs old and pushes the others back. Safe to call from any thread.
+    ----------------------------------------------------------------------*/
+
+    // A link keeps the index in its low 32 bits and the mark in bit 32
+    static const uint64_t MARK_BIT = uint64_t(1) << 32;
+    static uint64_t pack(IndexType idx) { return static_cast<uint32_t>(idx); }
+    static IndexType indexOf(uint64_t word) { return static_cast<IndexType>(word & 0xFFFFFFFFu); }
+    static bool isMarked(uint64_t word) { return (word & MARK_BIT) != 0; }
+    atomic<uint64_t>& link(IndexType idx) { return pool.value(idx).next; }
+    const atomic<uint64_t>& link(IndexType idx) const { return pool.value(idx).next; }
+
+    // An epoch slot holds (epoch << 1) | pinned for one handle
+    struct alignas(64) EpochSlot {
+        atomic<uint64_t> state{0};
+        atomic<bool> inUse{false};
+    };
+
+    PoolType pool;                          // Node pool shared by all handles
+    alignas(64) atomic<uint64_t> headLink;  // Link to the first node (never marked)
+    alignas(64) atomic<uint64_t> globalEpoch;  // Current reclamation epoch
+    EpochSlot slots[MAX_THREADS];           // Epoch announcements of the handles
+    atomic<Orphans*> orphans;               // Nodes left behind by destroyed handles
+};
+
+// Implementation
+
+template<typename T, int NUM_NODES, typename IndexType>
+const IndexType ConcurrentList<T, NUM_NODES, IndexType>::NULL_VALUE;
+
+template<typename T, int NUM_NODES, typename IndexType>
+const int ConcurrentList<T, NUM_NODES, IndexType>::MAX_THREADS;
+
+template<typename T, int NUM_NODES, typename IndexType>
+const int ConcurrentList<T, NUM_NODES, IndexType>::RETIRE_BATCH;
+
+template<typename T, int NUM_NODES, typename IndexType>
+const uint64_t ConcurrentList<T, NUM_NODES, IndexType>::MARK_BIT;
+
+template<typename T, int NUM_NODES, typename IndexType>
+ConcurrentList<T, NUM_NODES, IndexType>::ConcurrentList(int capacity)
+    : pool(capacity), headLink(pack(NULL_VALUE)), globalEpoch(1), orphans(nullptr) {}
+
+template<typename T, int NUM_NODES, typename IndexType>
+ConcurrentList<T, NUM_NODES, IndexType>::~ConcurrentList() {
+    // No handle remains, so every orphan can go back to the pool
+    Orphans* batch = orphans.load();
+    while (batch != nullptr) {
+        Orphans* following = batch->next;
+        for (IndexType idx : batch->nodes)
+            pool.deleteNode(idx);
+        delete batch;
+        batch = following;
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+ConcurrentList<T, NUM_NODES, IndexType>::Handle::Handle(ConcurrentList& list)
+    : list(list), magazine(list.pool), slot(-1), depth(0), localEpoch(0), retiredSinceAdvance(0) {
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        bool expected = false;
+        if (list.slots[i].inUse.compare_exchange_strong(expected, true)) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0)
+        throw overflow_error("ConcurrentList: too many handles");
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+ConcurrentList<T, NUM_NODES, IndexType>::Handle::~Handle() {
+    if (list.globalEpoch.load() >= localEpoch + 3) {
+        // Everything this handle unlinked is three epochs old
+        for (vector<IndexType>& bucket : limbo)
+            reclaim(bucket);
+    } else {
+        Orphans* batch = new Orphans{localEpoch, vector<IndexType>(), nullptr};
+        for (vector<IndexType>& bucket : limbo)
+            batch->nodes.insert(batch->nodes.end(), bucket.begin(), bucket.end());
+        if (batch->nodes.empty())
+            delete batch;
+        else
+            list.adoptOrphans(batch);
+    }
+    list.slots[slot].state.store(0);
+    list.slots[slot].inUse.store(false);
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void ConcurrentList<T, NUM_NODES, IndexType>::Handle::enter() {
+    if (depth++ > 0)
+        return;
+    uint64_t epoch = list.globalEpoch.load();
+    list.slots[slot].state.store((epoch << 1) | 1);
+    if (epoch != localEpoch) {
+        // This bucket was filled at least three epochs ago
+        localEpoch = epoch;
+        reclaim(limbo[epoch % 3]);
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void ConcurrentList<T, NUM_NODES, IndexType>::Handle::exit() {
+    if (--depth > 0)
+        return;
+    list.slots[slot].state.store(localEpoch << 1);
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void ConcurrentList<T, NUM_NODES, IndexType>::Handle::retire(IndexType idx) {
+    limbo[localEpoch % 3].push_back(idx);
+    if (++retiredSinceAdvance >= RETIRE_BATCH) {
+        retiredSinceAdvance = 0;
+        list.tryAdvance();
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void ConcurrentList<T, NUM_NODES, IndexType>::Handle::reclaim(vector<IndexType>& bucket) {
+    for (IndexType idx : bucket)
+        magazine.deleteNode(idx);
+    bucket.clear();
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void ConcurrentList<T, NUM_NODES, IndexType>::tryAdvance() {
+    uint64_t epoch = globalEpoch.load();
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        if (!slots[i].inUse.load())
+            continue;
+        uint64_t state = slots[i].state.load();
+        if ((state & 1) && (state >> 1) != epoch)
+            return;
+    }
+    if (globalEpoch.compare_exchange_strong(epoch, epoch + 1) && orphans.load() != nullptr)
+        reclaimOrphans();
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void ConcurrentList<T, NUM_NODES, IndexType>::adoptOrphans(Orphans* batch) {
+    batch->next = orphans.load();
+    while (!orphans.compare_exchange_weak(batch->next, batch)) {}
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void ConcurrentList<T, NUM_NODES, IndexType>::reclaimOrphans() {
+    // Taking the whole stack at once leaves no ABA window on its head
+    Orphans* batch = orphans.exchange(nullptr);
+    uint64_t epoch = globalEpoch.load();
+    while (batch != nullptr) {
+        Orphans* following = batch->next;
+        if (epoch >= batch->epoch + 3) {
+            for (IndexType idx : batch->nodes)
+                pool.deleteNode(idx);
+            delete batch;
+        } else {
+            adoptOrphans(batch);
+        }
+        batch = following;
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+template<typename... Args>
+IndexType ConcurrentList<T, NUM_NODES, IndexType>::allocNode(Handle& h, Args&&... args) {
+    return h.magazine.newNode(in_place, std::forward<Args>(args)...);
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+IndexType ConcurrentList<T, NUM_NODES, IndexType>::insertFront(Handle& h, const T& item) {
+    IndexType idx = allocNode(h, item);
+    uint64_t first = headLink.load(memory_order_acquire);
+    do {
+        link(idx).store(first, memory_order_relaxed);
+    } while (!headLink.compare_exchange_weak(first, pack(idx), memory_order_release, memory_order_acquire));
+    return idx;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+IndexType ConcurrentList<T, NUM_NODES, IndexType>::insertAfter(Handle& h, IndexType pos, const T& item) {
+    if (!pool.isValidIndex(pos))
+        throw out_of_range("ConcurrentList::insertAfter invalid position");
+    IndexType idx = allocNode(h, item);
+    uint64_t after = link(pos).load(memory_order_acquire);
+    while (true) {
+        if (isMarked(after)) {
+            // pos has been deleted; the new node was never published
+            h.magazine.deleteNode(idx);
+            return NULL_VALUE;
+        }
+        link(idx).store(after, memory_order_relaxed);
+        if (link(pos).compare_exchange_weak(after, pack(idx), memory_order_release, memory_order_acquire))
+            return idx;
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+IndexType ConcurrentList<T, NUM_NODES, IndexType>::insertSorted(Handle& h, const T& item) {
+    IndexType idx = allocNode(h, item);
+    const T& key = pool.value(idx).value;
+    while (true) {
+        atomic<uint64_t>* predLink;
+        IndexType curr;
+        locate(h, [&](IndexType node) { return !(pool.value(node).value < key); }, predLink, curr);
+        link(idx).store(pack(curr), memory_order_relaxed);
+        uint64_t expected = pack(curr);
+        if (predLink->compare_exchange_strong(expected, pack(idx), memory_order_release, memory_order_relaxed))
+            return idx;
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+bool ConcurrentList<T, NUM_NODES, IndexType>::deleteAfter(Handle& h, IndexType pos) {
+    if (!pool.isValidIndex(pos))
+        throw out_of_range("ConcurrentList::deleteAfter invalid position");
+    while (true) {
+        uint64_t first = link(pos).load(memory_order_acquire);
+        if (isMarked(first))
+            return false;   // pos itself has been deleted; it has no successor to delete
+        IndexType target = indexOf(first);
+        if (target == NULL_VALUE)
+            return false;
+        uint64_t after = link(target).load(memory_order_acquire);
+        if (isMarked(after))
+            return false;   // Another thread is deleting it
+        if (!link(target).compare_exchange_strong(after, after | MARK_BIT,
+                                                  memory_order_acq_rel, memory_order_acquire))
+            continue;
+        // Fails if pos was marked or gained a successor meanwhile; target stays deleted
+        uint64_t expected = first;
+        if (link(pos).compare_exchange_strong(expected, after, memory_order_acq_rel, memory_order_relaxed)) {
+            h.retire(target);
+        } else {
+            atomic<uint64_t>* predLink;
+            IndexType curr;
+            locate(h, [](IndexType) { return false; }, predLink, curr);
+        }
+        return true;
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+bool ConcurrentList<T, NUM_NODES, IndexType>::remove(Handle& h, const T& item) {
+    while (true) {
+        atomic<uint64_t>* predLink;
+        IndexType curr;
+        locate(h, [&](IndexType node) { return pool.value(node).value == item; }, predLink, curr);
+        if (curr == NULL_VALUE)
+            return false;
+        uint64_t after = link(curr).load(memory_order_acquire);
+        bool marked = false;
+        while (!isMarked(after)) {
+            if (link(curr).compare_exchange_weak(after, after | MARK_BIT,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+                marked = true;
+                break;
+            }
+        }
+        if (!marked)
+            continue;   // Another thread removed this node first; look again
+        uint64_t expected = pack(curr);
+        if (predLink->compare_exchange_strong(expected, after, memory_order_acq_rel, memory_order_relaxed))
+            h.retire(curr);
+        else
+            locate(h, [](IndexType) { return false; }, predLink, curr);
+        return true;
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+IndexType ConcurrentList<T, NUM_NODES, IndexType>::find(const T& item) const {
+    for (IndexType ptr = indexOf(headLink.load(memory_order_acquire)); ptr != NULL_VALUE;) {
+        uint64_t after = link(ptr).load(memory_order_acquire);
+        if (!isMarked(after) && pool.value(ptr).value == item)
+            return ptr;
+        ptr = indexOf(after);
+    }
+    return NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+template<typename F>
+void ConcurrentList<T, NUM_NODES, IndexType>::forEach(F& visit) const {
+    for (IndexType ptr = indexOf(headLink.load(memory_order_acquire)); ptr != NULL_VALUE;) {
+        uint64_t after = link(ptr).load(memory_order_acquire);
+        if (!isMarked(after))
+            visit(pool.value(ptr).value);
+        ptr = indexOf(after);
+    }
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+template<typename Stop>
+void ConcurrentList<T, NUM_NODES, IndexType>::locate(Handle& h, Stop stop,
+                                                     atomic<uint64_t>*& predLink, IndexType& curr) {
+    bool restart = true;
+    while (restart) {
+        restart = false;
+        predLink = &headLink;
+        curr = indexOf(predLink->load(memory_order_acquire));
+        while (curr != NULL_VALUE) {
+            uint64_t after = link(curr).load(memory_order_acquire);
+            if (isMarked(after)) {
+                // Help unlink the deleted node; a failure means predLink moved
+                uint64_t expected = pack(curr);
+                if (!predLink->compare_exchange_strong(expected, after & ~MARK_BIT,
+                                                       memory_order_acq_rel, memory_order_acquire)) {
+                    restart = true;
+                    break;
+                }
+                h.retire(curr);
+                curr = indexOf(after);
+                continue;
+            }
+            if (stop(curr))
+                return;
+            predLink = &link(curr);
+            curr = indexOf(after);
+        }
+    }
+}
+
+#endif // CONCURRENTLIST_H
@@ -0,0 +1,379 @@
+/*-- ConcurrentNodePool.h -------------------------------------------------
+
+  This header file defines the ConcurrentNodePool class, a thread-safe
+  counterpart of NodePool with a fixed capacity. Free nodes form a
+  lock-free Treiber stack. Its head is one atomic 64-bit word that packs
+  the index of the top node with a counter bumped on every update, so a
+  compare-and-swap cannot succeed against a stack that was popped and
+  pushed back to the same top in between (the ABA problem). Nodes never
+  used yet are handed out by an atomic high-water index, as in NodePool.
+  A Magazine is a per-thread cache of free nodes. It refills from the
+  shared stack, or the high-water region, several nodes per compare-and-
+  swap and flushes half of itself back in one compare-and-swap when full,
+  so most allocations and frees touch no shared cache line.
+  Links are atomic IndexType values whose largest value is NULL_VALUE;
+  while a node is allocated its link belongs to the caller.
+  Basic operations are:
+     Constructor:        Initializes the pool with a fixed capacity.
+     Destructor:         Destroys the data of nodes still allocated.
+     newNode:            Allocates a node from the shared free stack.
+     deleteNode:         Pushes a node back onto the shared free stack.
+     value:              Accessor to the data stored in a node.
+     next:               Accessor to the atomic link stored in a node.
+     capacity:           Returns the number of nodes the pool can hold.
+     isValidIndex:       Checks if an index lies in the used part of the pool.
+     Magazine:           Per-thread allocation cache over a pool.
+-------------------------------------------------------------------------*/
+
+#ifndef CONCURRENTNODEPOOL_H
+#define CONCURRENTNODEPOOL_H
+
+#include "NodePool.h"  // For SmallestIndex
+#include <atomic>      // For the tagged head and the links
+#include <stdexcept>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+using namespace std;
+
+template<typename ElementType, int NUM_NODES = 2048,
+         typename IndexType = typename SmallestIndex<NUM_NODES>::type>
+class ConcurrentNodePool {
+    static_assert(sizeof(IndexType) <= 4, "ConcurrentNodePool: IndexType must fit in 32 bits");
+
+public:
+    typedef IndexType Index;
+    static const IndexType NULL_VALUE = static_cast<IndexType>(~IndexType(0));  // Sentinel value indicating end of list
+    static const int MAX_CAPACITY =    // Largest number of nodes the index type can address
+        numeric_limits<IndexType>::max() < numeric_limits<int>::max()
+            ? static_cast<int>(numeric_limits<IndexType>::max())
+            : numeric_limits<int>::max();
+    static const int MAGAZINE_SIZE = 32;  // Nodes a Magazine caches at most
+
+    /***** Magazine *****/
+    class Magazine {
+    /*----------------------------------------------------------------------
+      Per-thread cache of free nodes. newNode and deleteNode work on the
+      cache and only reach the shared pool to refill an empty cache or to
+      flush a full one, each time moving MAGAZINE_SIZE / 2 nodes with a
+      single compare-and-swap. A Magazine must only be used by one thread
+      at a time and must be destroyed (or flushed) before its pool.
+    ----------------------------------------------------------------------*/
+    public:
+        explicit Magazine(ConcurrentNodePool& pool) : pool(pool), size(0) {}
+        Magazine(const Magazine&) = delete;
+        Magazine& operator=(const Magazine&) = delete;
+        ~Magazine() { flush(); }
+
+        template<typename... Args>
+        IndexType newNode(Args&&... args) {
+            if (size == 0)
+                size = pool.takeBatch(cache, MAGAZINE_SIZE / 2);
+            if (size == 0)
+                throw overflow_error("ConcurrentNodePool: out of free nodes");
+            IndexType index = cache[size - 1];
+            ::new (pool.slot(index)) ElementType(std::forward<Args>(args)...);
+            --size;
+            pool.next(index).store(NULL_VALUE, memory_order_relaxed);
+            return index;
+        }
+
+        void deleteNode(IndexType index) {
+            if (!pool.isValidIndex(index))
+                throw out_of_range("ConcurrentNodePool: deleteNode index out of range");
+            pool.value(index).~ElementType();
+            if (size == MAGAZINE_SIZE) {
+                // Hand the older half back; the newer half is warmer in cache
+                pool.giveBatch(cache, MAGAZINE_SIZE / 2);
+                for (int i = MAGAZINE_SIZE / 2; i < MAGAZINE_SIZE; ++i)
+                    cache[i - MAGAZINE_SIZE / 2] = cache[i];
+                size -= MAGAZINE_SIZE / 2;
+            }
+            cache[size++] = index;
+        }
+
+        void flush() {
+            if (size > 0)
+                pool.giveBatch(cache, size);
+            size = 0;
+        }
+
+    private:
+        ConcurrentNodePool& pool;          // Pool the cached nodes belong to
+        IndexType cache[MAGAZINE_SIZE];    // Free nodes, most recently freed last
+        int size;                          // Number of cached nodes
+    };
+
+    /***** Function Members ******/
+
+    /***** Constructor *****/
+    explicit ConcurrentNodePool(int initialCapacity = NUM_NODES);
+    /*----------------------------------------------------------------------
+      Constructor to allocate the node storage.
+      Precondition:  0 < initialCapacity <= MAX_CAPACITY.
+      Postcondition: Every node is free. The capacity never changes.
+      Throws:        invalid_argument if initialCapacity is out of range.
+    ----------------------------------------------------------------------*/
+
+    ConcurrentNodePool(const ConcurrentNodePool&) = delete;
+    ConcurrentNodePool& operator=(const ConcurrentNodePool&) = delete;
+
+    /***** Destructor *****/
+    ~ConcurrentNodePool();
+    /*----------------------------------------------------------------------
+      Destroys the data of every node still allocated.
+      Precondition:  No other thread uses the pool and every Magazine over
+                     it has been destroyed or flushed.
+      Postcondition: The storage has been released.
+    ----------------------------------------------------------------------*/
+
+    /***** newNode *****/
+    template<typename... Args>
+    IndexType newNode(Args&&... args);
+    /*----------------------------------------------------------------------
+      Allocates a node and constructs its data in place from args. Safe to
+      call from any number of threads; lock-free.
+      Precondition:  ElementType is constructible from args.
+      Postcondition: Returns the index of the new node, whose link is
+                     NULL_VALUE. If the constructor throws, the node is
+                     returned to the pool.
+      Throws:        overflow_error if the pool is out of free nodes.
+    ----------------------------------------------------------------------*/
+
+    /***** deleteNode *****/
+    void deleteNode(IndexType idx);
+    /*----------------------------------------------------------------------
+      Destroys the data of node idx and pushes it onto the free stack.
+      Safe to call from any number of threads; lock-free.
+      Precondition:  idx was allocated and no thread uses it any more.
+      Postcondition: The node can be handed out again.
+      Throws:        out_of_range if idx was never handed out.
+    ----------------------------------------------------------------------*/
+
+    /***** value *****/
+    ElementType& value(IndexType idx);
+    const ElementType& value(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Accessor to the data stored in node idx.
+      Precondition:  idx is allocated.
+      Postcondition: Returns a reference to the data.
+    ----------------------------------------------------------------------*/
+
+    /***** next *****/
+    atomic<IndexType>& next(IndexType idx);
+    const atomic<IndexType>& next(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Accessor to the atomic link stored in node idx.
+      Precondition:  0 <= idx < capacity().
+      Postcondition: Returns a reference to the link. The pool only uses
+                     the links of free nodes.
+    ----------------------------------------------------------------------*/
+
+    /***** capacity *****/
+    int capacity() const;
+    /*----------------------------------------------------------------------
+      Returns the number of nodes the pool can hold.
+      Precondition:  None
+      Postcondition: Returns the fixed capacity.
+    ----------------------------------------------------------------------*/
+
+    /***** isValidIndex *****/
+    bool isValidIndex(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Checks if an index lies below the high-water index.
+      Precondition:  None
+      Postcondition: Returns true if idx has been handed out at some point.
+    ----------------------------------------------------------------------*/
+
+private:
+    /***** takeBatch *****/
+    int takeBatch(IndexType* out, int n);
+    /*----------------------------------------------------------------------
+      Pops up to n free nodes with one compare-and-swap, falling back to
+      the high-water region when the stack is empty.
+      Precondition:  out has room for n indices.
+      Postcondition: Returns the number of nodes written to out (0 if the
+                     pool is exhausted).
+    ----------------------------------------------------------------------*/
+
+    /***** giveBatch *****/
+    void giveBatch(const IndexType* nodes, int n);
+    /*----------------------------------------------------------------------
+      Pushes n free nodes onto the stack with one compare-and-swap.
+      Precondition:  The nodes hold no live data and belong to no one.
+      Postcondition: The nodes are on the free stack.
+    ----------------------------------------------------------------------*/
+
+    /***** slot *****/
+    void* slot(IndexType idx);
+    /*----------------------------------------------------------------------
+      Maps an index to the raw data storage of its node.
+    ----------------------------------------------------------------------*/
+
+    // The tagged head keeps the top index in the low 32 bits, the tag above
+    static uint64_t pack(IndexType idx, uint64_t tag) {
+        return (tag << 32) | static_cast<uint32_t>(idx);
+    }
+    static IndexType indexOf(uint64_t word) { return static_cast<IndexType>(word & 0xFFFFFFFFu); }
+    static uint64_t tagOf(uint64_t word) { return word >> 32; }
+
+    struct NodeType {
+        alignas(ElementType) unsigned char data[sizeof(ElementType)];  // Raw storage for the data
+        atomic<IndexType> next;   // Index of the next node
+    };
+
+    unique_ptr<NodeType[]> nodes;                // Node storage
+    int nodeCapacity;                            // Number of nodes
+    alignas(64) atomic<uint64_t> freeHead;       // Tagged top of the free stack
+    alignas(64) atomic<int> highWater;           // First node never handed out
+};
+
+// Implementation
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const IndexType ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::NULL_VALUE;
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const int ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::MAX_CAPACITY;
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const int ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::MAGAZINE_SIZE;
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::ConcurrentNodePool(int initialCapacity)
+    : nodes(), nodeCapacity(initialCapacity), freeHead(pack(NULL_VALUE, 0)), highWater(0) {
+    if (initialCapacity <= 0 || initialCapacity > MAX_CAPACITY)
+        throw invalid_argument("ConcurrentNodePool: capacity out of range");
+    nodes.reset(new NodeType[initialCapacity]);
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::~ConcurrentNodePool() {
+    if (is_trivially_destructible<ElementType>::value)
+        return;
+    int used = highWater.load(memory_order_acquire);
+    vector<bool> isFree(used, false);
+    for (IndexType ptr = indexOf(freeHead.load(memory_order_acquire)); ptr != NULL_VALUE;
+         ptr = next(ptr).load(memory_order_relaxed))
+        isFree[static_cast<size_t>(ptr)] = true;
+    for (int i = 0; i < used; ++i) {
+        if (!isFree[i])
+            value(static_cast<IndexType>(i)).~ElementType();
+    }
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+template<typename... Args>
+IndexType ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::newNode(Args&&... args) {
+    IndexType index;
+    if (takeBatch(&index, 1) == 0)
+        throw overflow_error("ConcurrentNodePool: out of free nodes");
+    try {
+        ::new (slot(index)) ElementType(std::forward<Args>(args)...);
+    } catch (...) {
+        giveBatch(&index, 1);
+        throw;
+    }
+    next(index).store(NULL_VALUE, memory_order_relaxed);
+    return index;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+void ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::deleteNode(IndexType idx) {
+    if (!isValidIndex(idx))
+        throw out_of_range("ConcurrentNodePool: deleteNode index out of range");
+    value(idx).~ElementType();
+    giveBatch(&idx, 1);
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+ElementType& ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::value(IndexType idx) {
+    return *std::launder(reinterpret_cast<ElementType*>(nodes[idx].data));
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const ElementType& ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::value(IndexType idx) const {
+    return *std::launder(reinterpret_cast<const ElementType*>(nodes[idx].data));
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+atomic<IndexType>& ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::next(IndexType idx) {
+    return nodes[idx].next;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const atomic<IndexType>& ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::next(IndexType idx) const {
+    return nodes[idx].next;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+int ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::capacity() const {
+    return nodeCapacity;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+bool ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::isValidIndex(IndexType idx) const {
+    long long i = static_cast<long long>(idx);
+    return i >= 0 && i < highWater.load(memory_order_acquire);
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+int ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::takeBatch(IndexType* out, int n) {
+    uint64_t top = freeHead.load(memory_order_acquire);
+    while (indexOf(top) != NULL_VALUE) {
+        // Walk up to n nodes; if another thread changed the stack meanwhile
+        // the tag differs and the compare-and-swap fails, so the walk is
+        // only trusted when it succeeds. A popped node's link may already
+        // hold anything its new owner stored, so it is range-checked.
+        int taken = 0;
+        IndexType ptr = indexOf(top);
+        while (taken < n && ptr != NULL_VALUE) {
+            out[taken++] = ptr;
+            ptr = next(ptr).load(memory_order_relaxed);
+            if (ptr != NULL_VALUE && static_cast<long long>(ptr) >= nodeCapacity)
+                break;
+        }
+        if (ptr != NULL_VALUE && static_cast<long long>(ptr) >= nodeCapacity) {
+            top = freeHead.load(memory_order_acquire);
+            continue;
+        }
+        if (freeHead.compare_exchange_weak(top, pack(ptr, tagOf(top) + 1),
+                                           memory_order_acquire, memory_order_acquire))
+            return taken;
+    }
+
+    int start = highWater.load(memory_order_relaxed);
+    while (start < nodeCapacity) {
+        int end = (nodeCapacity - start < n) ? nodeCapacity : start + n;
+        if (highWater.compare_exchange_weak(start, end, memory_order_acq_rel, memory_order_relaxed)) {
+            for (int i = start; i < end; ++i)
+                out[i - start] = static_cast<IndexType>(i);
+            return end - start;
+        }
+    }
+    return 0;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+void ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::giveBatch(const IndexType* batch, int n) {
+    for (int i = 0; i + 1 < n; ++i)
+        next(batch[i]).store(batch[i + 1], memory_order_relaxed);
+    uint64_t top = freeHead.load(memory_order_relaxed);
+    do {
+        next(batch[n - 1]).store(indexOf(top), memory_order_relaxed);
+    } while (!freeHead.compare_exchange_weak(top, pack(batch[0], tagOf(top) + 1),
+                                             memory_order_release, memory_order_relaxed));
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+void* ConcurrentNodePool<ElementType, NUM_NODES, IndexType>::slot(IndexType idx) {
+    return nodes[idx].data;
+}
+
+#endif // CONCURRENTNODEPOOL_H
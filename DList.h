@@ -0,0 +1,788 @@
+/*-- DList.h --------------------------------------------------------------
+
+This header file defines the DList class, a doubly-linked counterpart of
+List built on the same NodePool. Each pool node carries the element and
+the index of its predecessor next to the pool's own next link, so a node
+known by its index can be erased, or have an element inserted before it,
+in O(1) without searching for its predecessor. The tail is maintained and
+the list can be walked in both directions.
+  Basic operations are:
+     Constructor:        Initializes an empty list.
+     Capacity Constructor: Initializes an empty list with a sized pool.
+     Copy Constructor:   Creates a copy of an existing list.
+     Move Constructor:   Takes over the nodes and pool of another list.
+     Assignment Operator:Assigns one list to another.
+     Move Assignment:    Replaces the contents by taking over another list.
+     Destructor:         Cleans up all list resources.
+     isEmpty:            Checks if the list is empty.
+     size:               Returns the number of elements in the list.
+     forEach:            Applies an inlinable callable to each element.
+     begin/end:          Bidirectional iterators over the list in order.
+     rbegin/rend:        Reverse iterators from the tail to the head.
+     front/back:         Return the node indices of the head and the tail.
+     prevOf/nextOf:      Return the neighbours of a node.
+     find:               Finds a node by its value.
+     clear:              Clears the list by deleting all elements.
+     insertFront:        Inserts an element at the front of the list.
+     pushBack:           Inserts an element at the end of the list.
+     insertAfter:        Inserts an element after a given node.
+     insertBefore:       Inserts an element before a given node.
+     emplace*:           Construct an element in place at those positions.
+     erase:              Deletes a given node in O(1).
+     deleteFront:        Deletes the front element of the list.
+     deleteBack:         Deletes the back element of the list.
+     remove:             Removes a node by its value.
+     getFreeListHead:    Returns the index of the first free node in the pool.
+     capacity:           Returns the number of nodes the pool can hold.
+     printList:          Prints list contents to std::cout.
+     operator<<:         Prints list contents to any std::ostream.
+-------------------------------------------------------------------------*/
+
+#ifndef DLIST_H
+#define DLIST_H
+
+#include "NodePool.h"
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+
+using namespace std;
+
+template<typename T, int NUM_NODES = 2048, typename Layout = InterleavedLayout,
+         typename IndexType = typename SmallestIndex<NUM_NODES>::type>
+class DList {
+public:
+    // DNode is the pool element: the list element plus its backward link
+    struct DNode {
+        IndexType prev;   // Index of the previous node (NULL_VALUE at the head)
+        T value;          // The element
+
+        template<typename... Args>
+        DNode(in_place_t, Args&&... args) : prev(), value(std::forward<Args>(args)...) {}
+    };
+
+    typedef NodePool<DNode, NUM_NODES, Layout, IndexType> PoolType;
+    typedef IndexType Index;
+    static const IndexType NULL_VALUE = PoolType::NULL_VALUE;
+
+    /***** Iterator *****/
+    template<bool IsConst>
+    class Iterator {
+    /*----------------------------------------------------------------------
+      Bidirectional iterator over the list. Decrementing end() yields the
+      tail. index() yields the node position, which can be passed to erase,
+      insertAfter and insertBefore. A non-const iterator converts to a
+      const one.
+    ----------------------------------------------------------------------*/
+    public:
+        typedef bidirectional_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef typename conditional<IsConst, const T*, T*>::type pointer;
+        typedef typename conditional<IsConst, const T&, T&>::type reference;
+        typedef typename conditional<IsConst, const DList*, DList*>::type ListPointer;
+
+        Iterator() : list(nullptr), idx(NULL_VALUE) {}
+        Iterator(ListPointer list, IndexType idx) : list(list), idx(idx) {}
+        template<bool C = IsConst, typename = typename enable_if<C>::type>
+        Iterator(const Iterator<false>& other) : list(other.list), idx(other.idx) {}
+
+        reference operator*() const { return list->pool->value(idx).value; }
+        pointer operator->() const { return &list->pool->value(idx).value; }
+        Iterator& operator++() { idx = list->pool->next(idx); return *this; }
+        Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+        Iterator& operator--() {
+            idx = (idx == NULL_VALUE) ? list->tail : list->pool->value(idx).prev;
+            return *this;
+        }
+        Iterator operator--(int) { Iterator old = *this; --*this; return old; }
+        IndexType index() const { return idx; }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.idx == b.idx; }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.idx != b.idx; }
+
+    private:
+        template<bool> friend class Iterator;
+
+        ListPointer list;  // List the iterator walks
+        IndexType idx;     // Index of the current node (NULL_VALUE at end)
+    };
+
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    /***** Function Members ******/
+
+    /***** Constructor *****/
+    DList();
+    /*----------------------------------------------------------------------
+      Constructor for the DList class.
+      Precondition:  None
+      Postcondition: A new empty DList object has been created.
+    ----------------------------------------------------------------------*/
+
+    /***** Capacity Constructor *****/
+    explicit DList(int initialCapacity, bool growable = false);
+    /*----------------------------------------------------------------------
+      Constructor for a DList whose pool holds initialCapacity nodes.
+      Precondition:  0 < initialCapacity <= PoolType::MAX_CAPACITY.
+      Postcondition: A new empty DList object has been created. If
+                     growable is true the pool extends itself in chunks
+                     when full instead of throwing overflow_error.
+    ----------------------------------------------------------------------*/
+
+    /***** Copy Constructor *****/
+    DList(const DList& other);
+    /*----------------------------------------------------------------------
+      Creates a new list as a copy of another list.
+      Precondition:  None
+      Postcondition: A new DList owns a pool of the same capacity and
+                     growth mode as other and holds the same elements.
+    ----------------------------------------------------------------------*/
+
+    /***** Assignment Operator *****/
+    DList& operator=(const DList& other);
+    /*----------------------------------------------------------------------
+      Assigns the contents of another list to this list.
+      Precondition:  None
+      Postcondition: This list holds the same elements as other.
+                     Returns a reference to this list.
+    ----------------------------------------------------------------------*/
+
+    /***** Move Constructor *****/
+    DList(DList&& other) noexcept;
+    /*----------------------------------------------------------------------
+      Creates a new list by taking over the pool and nodes of other.
+      Precondition:  None
+      Postcondition: This list holds other's former elements at their
+                     former positions; other is empty and gets a new pool
+                     on its next insert.
+    ----------------------------------------------------------------------*/
+
+    /***** Move Assignment *****/
+    DList& operator=(DList&& other) noexcept;
+    /*----------------------------------------------------------------------
+      Replaces the contents of this list by taking over other's pool.
+      Precondition:  None
+      Postcondition: As for the move constructor. Returns *this.
+    ----------------------------------------------------------------------*/
+
+    /***** Destructor *****/
+    ~DList();
+    /*----------------------------------------------------------------------
+      Destructor for the DList class.
+      Precondition:  None
+      Postcondition: All elements are destroyed and the pool is released.
+    ----------------------------------------------------------------------*/
+
+    /***** isEmpty *****/
+    bool isEmpty() const;
+    /*----------------------------------------------------------------------
+      Checks if the list is empty.
+      Precondition:  None
+      Postcondition: Returns true if the list is empty, false otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** size *****/
+    int size() const;
+    /*----------------------------------------------------------------------
+      Returns the number of elements in the list.
+      Precondition:  None
+      Postcondition: Returns the element count in O(1).
+    ----------------------------------------------------------------------*/
+
+    /***** forEach *****/
+    template<typename F>
+    void forEach(F&& visit);
+    template<typename F>
+    void forEach(F&& visit) const;
+    /*----------------------------------------------------------------------
+      Applies visit to each element from the head to the tail.
+      Precondition:  visit must not insert into or delete from this list.
+      Postcondition: visit has been called once per element, in order.
+    ----------------------------------------------------------------------*/
+
+    /***** begin / end *****/
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    /*----------------------------------------------------------------------
+      Return iterators to the first element and past the last element.
+      Precondition:  None
+      Postcondition: Iterators stay valid until their node is erased.
+    ----------------------------------------------------------------------*/
+
+    /***** rbegin / rend *****/
+    reverse_iterator rbegin();
+    reverse_iterator rend();
+    const_reverse_iterator rbegin() const;
+    const_reverse_iterator rend() const;
+    const_reverse_iterator crbegin() const;
+    const_reverse_iterator crend() const;
+    /*----------------------------------------------------------------------
+      Return reverse iterators that walk from the tail to the head.
+      Precondition:  None
+      Postcondition: rbegin() refers to the tail element.
+    ----------------------------------------------------------------------*/
+
+    /***** front / back *****/
+    IndexType front() const;
+    IndexType back() const;
+    /*----------------------------------------------------------------------
+      Return the node index of the head or of the tail.
+      Precondition:  None
+      Postcondition: Returns NULL_VALUE if the list is empty.
+    ----------------------------------------------------------------------*/
+
+    /***** prevOf / nextOf *****/
+    IndexType prevOf(IndexType idx) const;
+    IndexType nextOf(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Return the node before or after idx.
+      Precondition:  idx is a node of this list.
+      Postcondition: Returns NULL_VALUE past either end.
+    ----------------------------------------------------------------------*/
+
+    /***** value *****/
+    T& value(IndexType idx);
+    const T& value(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Accessor to the element stored in node idx.
+      Precondition:  idx is a node of this list.
+      Postcondition: Returns a reference to the element.
+    ----------------------------------------------------------------------*/
+
+    /***** find *****/
+    IndexType find(const T& item) const;
+    /*----------------------------------------------------------------------
+      Searches for an item in the list.
+      Precondition:  None
+      Postcondition: Returns the index of the first node equal to item,
+                     NULL_VALUE otherwise. The result can go straight to
+                     erase.
+    ----------------------------------------------------------------------*/
+
+    /***** clear *****/
+    void clear();
+    /*----------------------------------------------------------------------
+      Removes all elements from the list.
+      Precondition:  None
+      Postcondition: The list is empty.
+    ----------------------------------------------------------------------*/
+
+    /***** insertFront *****/
+    void insertFront(const T& item);
+    void insertFront(T&& item);
+    /***** emplaceFront *****/
+    template<typename... Args>
+    IndexType emplaceFront(Args&&... args);
+    /*----------------------------------------------------------------------
+      Inserts an element at the front of the list.
+      Precondition:  None
+      Postcondition: The element is the new head. emplaceFront returns the
+                     index of its node.
+    ----------------------------------------------------------------------*/
+
+    /***** pushBack *****/
+    void pushBack(const T& item);
+    void pushBack(T&& item);
+    /***** emplaceBack *****/
+    template<typename... Args>
+    IndexType emplaceBack(Args&&... args);
+    /*----------------------------------------------------------------------
+      Inserts an element at the end of the list in O(1).
+      Precondition:  None
+      Postcondition: The element is the new tail. emplaceBack returns the
+                     index of its node.
+    ----------------------------------------------------------------------*/
+
+    /***** insertAfter *****/
+    void insertAfter(IndexType pos, const T& item);
+    void insertAfter(IndexType pos, T&& item);
+    /***** emplaceAfter *****/
+    template<typename... Args>
+    IndexType emplaceAfter(IndexType pos, Args&&... args);
+    /*----------------------------------------------------------------------
+      Inserts an element right after node pos in O(1).
+      Precondition:  pos is a node of this list.
+      Postcondition: The element follows pos. emplaceAfter returns the
+                     index of its node.
+      Throws:        out_of_range if pos is not an allocated node.
+    ----------------------------------------------------------------------*/
+
+    /***** insertBefore *****/
+    void insertBefore(IndexType pos, const T& item);
+    void insertBefore(IndexType pos, T&& item);
+    /***** emplaceBefore *****/
+    template<typename... Args>
+    IndexType emplaceBefore(IndexType pos, Args&&... args);
+    /*----------------------------------------------------------------------
+      Inserts an element right before node pos in O(1).
+      Precondition:  pos is a node of this list.
+      Postcondition: The element precedes pos. emplaceBefore returns the
+                     index of its node.
+      Throws:        out_of_range if pos is not an allocated node.
+    ----------------------------------------------------------------------*/
+
+    /***** erase *****/
+    IndexType erase(IndexType idx);
+    /*----------------------------------------------------------------------
+      Unlinks node idx and returns it to the pool in O(1).
+      Precondition:  idx is a node of this list.
+      Postcondition: The element is destroyed. Returns the node that
+                     followed idx (NULL_VALUE if idx was the tail).
+      Throws:        underflow_error on an empty list, out_of_range if idx
+                     is not an allocated node.
+    ----------------------------------------------------------------------*/
+
+    /***** deleteFront *****/
+    void deleteFront();
+    /***** deleteBack *****/
+    void deleteBack();
+    /*----------------------------------------------------------------------
+      Delete the head or the tail element in O(1).
+      Precondition:  None
+      Postcondition: The element is destroyed and its node recycled.
+      Throws:        underflow_error on an empty list.
+    ----------------------------------------------------------------------*/
+
+    /***** remove *****/
+    bool remove(const T& item);
+    /*----------------------------------------------------------------------
+      Removes the first occurrence of an item from the list.
+      Precondition:  None
+      Postcondition: Returns true if item was found and removed, false
+                     otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** getFreeListHead *****/
+    IndexType getFreeListHead() const;
+    /*----------------------------------------------------------------------
+      Returns the index of the next node the pool hands out.
+      Precondition:  None
+      Postcondition: Returns NULL_VALUE if the pool is full.
+    ----------------------------------------------------------------------*/
+
+    /***** capacity *****/
+    int capacity() const;
+    /*----------------------------------------------------------------------
+      Returns the number of nodes the list's pool can currently hold.
+      Precondition:  None
+      Postcondition: Returns the pool capacity.
+    ----------------------------------------------------------------------*/
+
+    /***** printList *****/
+    void printList() const;
+    /*----------------------------------------------------------------------
+      Prints the list contents to standard output.
+      Precondition:  None
+      Postcondition: List elements and free list head are printed to cout.
+    ----------------------------------------------------------------------*/
+
+private:
+    /***** allocNode *****/
+    template<typename... Args>
+    IndexType allocNode(Args&&... args);
+    /*----------------------------------------------------------------------
+      Allocates an unlinked node holding a T constructed from args.
+      Precondition:  None
+      Postcondition: Returns the new node. A list left without a pool by a
+                     move gets a default pool first.
+    ----------------------------------------------------------------------*/
+
+    /***** linkBetween *****/
+    void linkBetween(IndexType idx, IndexType before, IndexType after);
+    /*----------------------------------------------------------------------
+      Links node idx between two neighbours.
+      Precondition:  before is followed by after (either may be NULL_VALUE
+                     at the ends of the list).
+      Postcondition: before, idx and after are adjacent; head, tail and the
+                     count are updated.
+    ----------------------------------------------------------------------*/
+
+    /***** checkNode *****/
+    void checkNode(IndexType idx, const char* what) const;
+    /*----------------------------------------------------------------------
+      Throws out_of_range with message what unless idx is an allocated
+      node; a recycled index is rejected too.
+    ----------------------------------------------------------------------*/
+
+    unique_ptr<PoolType> ownedPool;  // Pool owned by this list
+    PoolType* pool;               // Node pool (null after being moved from)
+    IndexType head;               // Index of the first node in the list
+    IndexType tail;               // Index of the last node in the list
+    int count;                    // Number of elements in the list
+};
+
+// Implementation
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+const IndexType DList<T, NUM_NODES, Layout, IndexType>::NULL_VALUE;
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+DList<T, NUM_NODES, Layout, IndexType>::DList()
+    : ownedPool(new PoolType()), pool(ownedPool.get()),
+      head(NULL_VALUE), tail(NULL_VALUE), count(0) {}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+DList<T, NUM_NODES, Layout, IndexType>::DList(int initialCapacity, bool growable)
+    : ownedPool(new PoolType(initialCapacity, growable)), pool(ownedPool.get()),
+      head(NULL_VALUE), tail(NULL_VALUE), count(0) {}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+DList<T, NUM_NODES, Layout, IndexType>::DList(const DList& other)
+    : ownedPool(other.pool ? new PoolType(other.pool->capacity(), other.pool->isGrowable())
+                           : new PoolType()),
+      pool(ownedPool.get()), head(NULL_VALUE), tail(NULL_VALUE), count(0) {
+    for (const T& item : other)
+        pushBack(item);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+DList<T, NUM_NODES, Layout, IndexType>& DList<T, NUM_NODES, Layout, IndexType>::operator=(const DList& other) {
+    if (this != &other) {
+        clear();
+        for (const T& item : other)
+            pushBack(item);
+    }
+    return *this;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+DList<T, NUM_NODES, Layout, IndexType>::DList(DList&& other) noexcept
+    : ownedPool(std::move(other.ownedPool)), pool(other.pool),
+      head(other.head), tail(other.tail), count(other.count) {
+    other.pool = nullptr;
+    other.head = other.tail = NULL_VALUE;
+    other.count = 0;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+DList<T, NUM_NODES, Layout, IndexType>& DList<T, NUM_NODES, Layout, IndexType>::operator=(DList&& other) noexcept {
+    if (this != &other) {
+        clear();
+        ownedPool = std::move(other.ownedPool);
+        pool = other.pool;
+        head = other.head;
+        tail = other.tail;
+        count = other.count;
+        other.pool = nullptr;
+        other.head = other.tail = NULL_VALUE;
+        other.count = 0;
+    }
+    return *this;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+DList<T, NUM_NODES, Layout, IndexType>::~DList() {
+    clear();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+bool DList<T, NUM_NODES, Layout, IndexType>::isEmpty() const {
+    return head == NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+int DList<T, NUM_NODES, Layout, IndexType>::size() const {
+    return count;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+template<typename F>
+void DList<T, NUM_NODES, Layout, IndexType>::forEach(F&& visit) {
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr))
+        visit(pool->value(ptr).value);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+template<typename F>
+void DList<T, NUM_NODES, Layout, IndexType>::forEach(F&& visit) const {
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr))
+        visit(pool->value(ptr).value);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::iterator DList<T, NUM_NODES, Layout, IndexType>::begin() {
+    return iterator(this, head);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::iterator DList<T, NUM_NODES, Layout, IndexType>::end() {
+    return iterator(this, NULL_VALUE);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::const_iterator DList<T, NUM_NODES, Layout, IndexType>::begin() const {
+    return const_iterator(this, head);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::const_iterator DList<T, NUM_NODES, Layout, IndexType>::end() const {
+    return const_iterator(this, NULL_VALUE);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::const_iterator DList<T, NUM_NODES, Layout, IndexType>::cbegin() const {
+    return begin();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::const_iterator DList<T, NUM_NODES, Layout, IndexType>::cend() const {
+    return end();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::reverse_iterator DList<T, NUM_NODES, Layout, IndexType>::rbegin() {
+    return reverse_iterator(end());
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::reverse_iterator DList<T, NUM_NODES, Layout, IndexType>::rend() {
+    return reverse_iterator(begin());
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::const_reverse_iterator DList<T, NUM_NODES, Layout, IndexType>::rbegin() const {
+    return const_reverse_iterator(end());
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::const_reverse_iterator DList<T, NUM_NODES, Layout, IndexType>::rend() const {
+    return const_reverse_iterator(begin());
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::const_reverse_iterator DList<T, NUM_NODES, Layout, IndexType>::crbegin() const {
+    return rbegin();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+typename DList<T, NUM_NODES, Layout, IndexType>::const_reverse_iterator DList<T, NUM_NODES, Layout, IndexType>::crend() const {
+    return rend();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::front() const {
+    return head;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::back() const {
+    return tail;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::prevOf(IndexType idx) const {
+    return pool->value(idx).prev;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::nextOf(IndexType idx) const {
+    return pool->next(idx);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+T& DList<T, NUM_NODES, Layout, IndexType>::value(IndexType idx) {
+    return pool->value(idx).value;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+const T& DList<T, NUM_NODES, Layout, IndexType>::value(IndexType idx) const {
+    return pool->value(idx).value;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::find(const T& item) const {
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr)) {
+        if (pool->value(ptr).value == item)
+            return ptr;
+    }
+    return NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::clear() {
+    while (!isEmpty()) deleteFront();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::insertFront(const T& item) {
+    emplaceFront(item);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::insertFront(T&& item) {
+    emplaceFront(std::move(item));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+template<typename... Args>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::emplaceFront(Args&&... args) {
+    IndexType idx = allocNode(std::forward<Args>(args)...);
+    linkBetween(idx, NULL_VALUE, head);
+    return idx;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::pushBack(const T& item) {
+    emplaceBack(item);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::pushBack(T&& item) {
+    emplaceBack(std::move(item));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+template<typename... Args>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::emplaceBack(Args&&... args) {
+    IndexType idx = allocNode(std::forward<Args>(args)...);
+    linkBetween(idx, tail, NULL_VALUE);
+    return idx;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::insertAfter(IndexType pos, const T& item) {
+    emplaceAfter(pos, item);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::insertAfter(IndexType pos, T&& item) {
+    emplaceAfter(pos, std::move(item));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+template<typename... Args>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::emplaceAfter(IndexType pos, Args&&... args) {
+    checkNode(pos, "DList::insertAfter invalid position");
+    IndexType idx = allocNode(std::forward<Args>(args)...);
+    linkBetween(idx, pos, pool->next(pos));
+    return idx;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::insertBefore(IndexType pos, const T& item) {
+    emplaceBefore(pos, item);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::insertBefore(IndexType pos, T&& item) {
+    emplaceBefore(pos, std::move(item));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+template<typename... Args>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::emplaceBefore(IndexType pos, Args&&... args) {
+    checkNode(pos, "DList::insertBefore invalid position");
+    IndexType idx = allocNode(std::forward<Args>(args)...);
+    linkBetween(idx, pool->value(pos).prev, pos);
+    return idx;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::erase(IndexType idx) {
+    if (isEmpty())
+        throw underflow_error("DList::erase() on empty list");
+    checkNode(idx, "DList::erase invalid position");
+    IndexType before = pool->value(idx).prev;
+    IndexType after = pool->next(idx);
+    if (before == NULL_VALUE)
+        head = after;
+    else
+        pool->next(before) = after;
+    if (after == NULL_VALUE)
+        tail = before;
+    else
+        pool->value(after).prev = before;
+    pool->deleteNode(idx);
+    --count;
+    return after;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::deleteFront() {
+    if (isEmpty())
+        throw underflow_error("DList::deleteFront() on empty list");
+    erase(head);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::deleteBack() {
+    if (isEmpty())
+        throw underflow_error("DList::deleteBack() on empty list");
+    erase(tail);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+bool DList<T, NUM_NODES, Layout, IndexType>::remove(const T& item) {
+    IndexType idx = find(item);
+    if (idx == NULL_VALUE)
+        return false;
+    erase(idx);
+    return true;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::getFreeListHead() const {
+    return pool ? pool->getFreeListHead() : NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+int DList<T, NUM_NODES, Layout, IndexType>::capacity() const {
+    return pool ? pool->capacity() : 0;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::printList() const {
+    cout << *this;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+template<typename... Args>
+IndexType DList<T, NUM_NODES, Layout, IndexType>::allocNode(Args&&... args) {
+    if (!pool) {
+        ownedPool.reset(new PoolType());
+        pool = ownedPool.get();
+    }
+    return pool->newNode(in_place, std::forward<Args>(args)...);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::linkBetween(IndexType idx, IndexType before, IndexType after) {
+    pool->value(idx).prev = before;
+    pool->next(idx) = after;
+    if (before == NULL_VALUE)
+        head = idx;
+    else
+        pool->next(before) = idx;
+    if (after == NULL_VALUE)
+        tail = idx;
+    else
+        pool->value(after).prev = idx;
+    ++count;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+void DList<T, NUM_NODES, Layout, IndexType>::checkNode(IndexType idx, const char* what) const {
+    if (!pool || !pool->isLive(idx))
+        throw out_of_range(what);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType>
+ostream& operator<<(ostream& os, const DList<T, NUM_NODES, Layout, IndexType>& lst) {
+    for (const T& s : lst)
+        os << s << " ";
+    os << "\nFree-list head index: " << +lst.getFreeListHead() << "\n";
+    return os;
+}
+#endif // DLIST_H
@@ -1,26 +1,72 @@
 /*-- List.h ---------------------------------------------------------------
 
 This header file defines the List class for managing a linked list of nodes.
+The Layout parameter selects the NodePool node layout; SplitLayout keeps
+links apart from elements so walks that only follow links stay compact.
+Positions are IndexType values (by default the smallest unsigned type that
+fits NUM_NODES) and NULL_VALUE is that type's largest value.
+The Stats policy (see PoolStats.h) is shared with the pool and decides
+what is recorded for stats(); the default, NoStats, compiles to nothing.
   Basic operations are:
      Constructor:        Initializes an empty list.
+     Capacity Constructor: Initializes an empty list with a sized pool.
+     Shared Pool Constructor: Initializes an empty list on an external pool.
      Copy Constructor:   Creates a copy of an existing list.
+     Move Constructor:   Takes over the nodes and pool of another list.
      Assignment Operator:Assigns one list to another.
+     Move Assignment:    Replaces the contents by taking over another list.
      Destructor:         Cleans up all list resources.
      isEmpty:            Checks if the list is empty.
      traverse:           Traverses and applies a function to each element.
+     forEach:            Applies an inlinable callable to each element.
+     begin/end:          Forward iterators over the list in order.
      size:               Returns the number of elements in the list.
      find:               Finds a node by its value.
+     findMany:           Finds the nodes of a batch of values in one walk.
+     contains:           Checks if a value is in the list.
+     countOf:            Counts the elements equal to a value.
+     forEachUnordered:   Applies a callable to each element in pool order.
      clear:              Clears the list by deleting all elements.
      insertFront:        Inserts an element at the front of the list.
+     emplaceFront:       Constructs an element in place at the front.
      deleteFront:        Deletes the front element of the list.
      insertAfter:        Inserts an element after a given position.
+     emplaceAfter:       Constructs an element in place after a given position.
      deleteAfter:        Deletes an element after a given position.
-     insertBack:         Inserts an element at the end of the list.
+     pushBack:           Inserts an element at the end of the list in O(1).
+     emplaceBack:        Constructs an element in place at the end in O(1).
+     append:             Appends a range of elements in one pass.
+     assign:             Replaces the contents with a range of elements.
      insertSorted:       Inserts an element in sorted order.
+     emplaceSorted:      Constructs an element in place in sorted order.
      remove:             Removes a node by its value.
-     sortList:           Sorts the list in ascending order.
+     sortList:           Sorts the list (stable merge sort, optional comparator).
+     enableIndex:        Keeps a value-to-node hash index for O(1) find/remove.
+     disableIndex:       Drops the value-to-node hash index.
+     isIndexed:          Checks if the hash index is enabled.
+     enableSortedIndex:  Keeps skip-list lanes for O(log n) ordered search.
+     disableSortedIndex: Drops the skip-list lanes.
+     hasSortedIndex:     Checks if the skip-list lanes are enabled.
+     lowerBound:         Finds the first node not less than a value.
+     upperBound:         Finds the first node greater than a value.
+     forEachInRange:     Applies a callable to each element in [low, high).
      unique:             Removes duplicate elements from the list.
+     uniqueAdjacent:     Removes runs of equal elements in one pass.
      getFreeListHead:    Returns the index of the first free node in the pool.
+     capacity:           Returns the number of nodes the pool can hold.
+     reserve:            Grows the pool to hold at least a given number of nodes.
+     shrinkToFit:        Releases unused trailing pool storage.
+     compact:            Moves the nodes into list order at the front of the pool.
+     fragmentation:      Measures how far the chain jumps around the pool.
+     setAutoCompact:     Compacts automatically above a fragmentation level.
+     stats:              Returns a snapshot of the search and pool counters.
+     splice:             Moves all nodes of a list sharing the pool in O(1),
+                         or a range of them.
+     mergeSorted:        Merges another sorted list into this one.
+     insertSortedRange:  Inserts a batch of elements in sorted order.
+     removeIf:           Removes every element matching a predicate.
+     saveBinary:         Writes a binary snapshot of the list to a stream.
+     loadBinary:         Replaces the contents with a binary snapshot.
      printList:          Prints list contents to std::cout.
      operator<<:         Prints list contents to any std::ostream.
 -------------------------------------------------------------------------*/
@@ -30,17 +76,74 @@ This header file defines the List class for managing a linked list of nodes.
 #define LIST_H
 
 #include "NodePool.h"
+#include "ListTraits.h"
 #include <functional>
 #include <stdexcept>
 #include <iostream>
 #include <string>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <cstddef>
+#include <type_traits>
+#include <unordered_set>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <typeinfo>
 
 using namespace std;
 
-template<typename T, int NUM_NODES = 2048>
-class List {
+template<typename T, int NUM_NODES = 2048, typename Layout = InterleavedLayout,
+         typename IndexType = typename SmallestIndex<NUM_NODES>::type, typename Stats = NoStats>
+class List : private Stats {
 public:
-    static const int NULL_VALUE = NodePool<T, NUM_NODES>::NULL_VALUE;
+    typedef NodePool<T, NUM_NODES, Layout, IndexType, Stats> PoolType;
+    typedef IndexType Index;
+    static const IndexType NULL_VALUE = PoolType::NULL_VALUE;
+
+    /***** Iterator *****/
+    template<bool IsConst>
+    class Iterator {
+    /*----------------------------------------------------------------------
+      Forward iterator that follows the next links of the list's chain.
+      Dereferencing yields the element; index() yields its node position,
+      which can be passed to insertAfter and deleteAfter. A non-const
+      iterator converts to a const one.
+    ----------------------------------------------------------------------*/
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef typename conditional<IsConst, const T*, T*>::type pointer;
+        typedef typename conditional<IsConst, const T&, T&>::type reference;
+        typedef typename conditional<IsConst, const PoolType*, PoolType*>::type PoolPointer;
+
+        Iterator() : pool(nullptr), idx(NULL_VALUE) {}
+        Iterator(PoolPointer pool, IndexType idx) : pool(pool), idx(idx) {}
+        template<bool C = IsConst, typename = typename enable_if<C>::type>
+        Iterator(const Iterator<false>& other) : pool(other.pool), idx(other.idx) {}
+
+        reference operator*() const { return pool->value(idx); }
+        pointer operator->() const { return &pool->value(idx); }
+        Iterator& operator++() { idx = pool->next(idx); return *this; }
+        Iterator operator++(int) { Iterator old = *this; idx = pool->next(idx); return old; }
+        IndexType index() const { return idx; }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) { return a.idx == b.idx; }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return a.idx != b.idx; }
+
+    private:
+        template<bool> friend class Iterator;
+
+        PoolPointer pool;  // Pool holding the nodes
+        IndexType idx;     // Index of the current node (NULL_VALUE at end)
+    };
+
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
 
     /***** Function Members ******/
 
@@ -52,12 +155,36 @@ public:
       Postcondition: A new empty List object has been created (head is NULL_VALUE).
     ----------------------------------------------------------------------*/
 
+    /***** Capacity Constructor *****/
+    explicit List(int initialCapacity, bool growable = false);
+    /*----------------------------------------------------------------------
+      Constructor for a List whose pool holds initialCapacity nodes.
+      Precondition:  0 < initialCapacity <= PoolType::MAX_CAPACITY.
+      Postcondition: A new empty List object has been created. If growable
+                     is true the pool extends itself in chunks when full,
+                     up to PoolType::MAX_CAPACITY nodes, instead of
+                     throwing overflow_error.
+    ----------------------------------------------------------------------*/
+
+    /***** Shared Pool Constructor *****/
+    explicit List(PoolType& sharedPool);
+    /*----------------------------------------------------------------------
+      Constructor for a List that draws its nodes from an external pool.
+      Precondition:  sharedPool outlives this list.
+      Postcondition: A new empty List object has been created. Its nodes
+                     are allocated from and returned to sharedPool, which
+                     may back any number of other lists.
+    ----------------------------------------------------------------------*/
+
     /***** Copy Constructor *****/
     List(const List& other);
     /*----------------------------------------------------------------------
       Creates a new list as a copy of another list.
       Precondition:  other is a valid List object.
       Postcondition: A new List object is created with the same elements as other.
+                     If other uses a shared pool the copy uses the same pool;
+                     otherwise it owns a pool of the same capacity and
+                     growth mode.
     ----------------------------------------------------------------------*/
 
     /***** Assignment Operator *****/
@@ -69,6 +196,26 @@ public:
                      Returns a reference to this list.
     ----------------------------------------------------------------------*/
 
+    /***** Move Constructor *****/
+    List(List&& other) noexcept;
+    /*----------------------------------------------------------------------
+      Creates a new list by taking over the contents of another list.
+      Precondition:  other is a valid List object.
+      Postcondition: This list holds other's nodes and uses other's pool; no
+                     element is copied. other is empty. If other owned its
+                     pool, it gets a new default pool on its next insert.
+    ----------------------------------------------------------------------*/
+
+    /***** Move Assignment *****/
+    List& operator=(List&& other) noexcept;
+    /*----------------------------------------------------------------------
+      Replaces the contents of this list by taking over another list.
+      Precondition:  other is a valid List object.
+      Postcondition: This list's old elements are released, and it holds
+                     other's nodes, pool, index and lanes. other is empty.
+                     Nothing is allocated. Returns a reference to this list.
+    ----------------------------------------------------------------------*/
+
     /***** Destructor *****/
     ~List();
     /*----------------------------------------------------------------------
@@ -93,20 +240,98 @@ public:
       Postcondition: visit has been applied to each element in order.
     ----------------------------------------------------------------------*/
 
+    /***** forEach *****/
+    template<typename F>
+    void forEach(F&& visit);
+    template<typename F>
+    void forEach(F&& visit) const;
+    /*----------------------------------------------------------------------
+      Applies a callable to each element in the list.
+      Precondition:  visit can be called with a T& (const T& for a const list).
+      Postcondition: visit has been applied to each element in order. Unlike
+                     traverse, the call is not type-erased and can be inlined.
+    ----------------------------------------------------------------------*/
+
+    /***** begin / end *****/
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    /*----------------------------------------------------------------------
+      Return iterators to the first element and one past the last element.
+      Precondition:  None
+      Postcondition: [begin(), end()) visits every element in list order.
+                     Iterators stay valid until their node is deleted.
+    ----------------------------------------------------------------------*/
+
     /***** size *****/
     int size() const;
     /*----------------------------------------------------------------------
       Returns the number of elements in the list.
       Precondition:  None
-      Postcondition: Returns the count of elements in the list.
+      Postcondition: Returns the count of elements in the list in O(1).
     ----------------------------------------------------------------------*/
 
     /***** find *****/
-    int find(const T& item) const;
+    IndexType find(const T& item) const;
     /*----------------------------------------------------------------------
       Searches for an item in the list.
       Precondition:  None
       Postcondition: Returns the index of the item if found, NULL_VALUE otherwise.
+                     With the hash index enabled the lookup is O(1) on
+                     average and, if item occurs more than once, may return
+                     any of its nodes rather than the first one.
+    ----------------------------------------------------------------------*/
+
+    /***** findMany *****/
+    void findMany(const T* keys, int n, IndexType* out) const;
+    /*----------------------------------------------------------------------
+      Searches for a batch of items.
+      Precondition:  keys points to n items and out to room for n indices.
+      Postcondition: out[i] == find(keys[i]) for every i. Rather than one
+                     walk per key, a single walk serves the whole batch
+                     when T is hashable (FIND_BATCH keys per walk
+                     otherwise), and stops once every key is found.
+                     With the hash index enabled each key is looked up
+                     directly.
+    ----------------------------------------------------------------------*/
+
+    /***** contains *****/
+    bool contains(const T& item) const;
+    /*----------------------------------------------------------------------
+      Checks if an item is in the list.
+      Precondition:  None
+      Postcondition: Returns true if some element equals item. O(1) on
+                     average with the hash index enabled. Otherwise, if the
+                     list owns its pool, the pool is scanned linearly by
+                     its liveness bitmap instead of following links.
+    ----------------------------------------------------------------------*/
+
+    /***** countOf *****/
+    int countOf(const T& item) const;
+    /*----------------------------------------------------------------------
+      Counts the elements equal to item.
+      Precondition:  None
+      Postcondition: Returns the number of matching elements. If the list
+                     owns its pool, the pool is scanned linearly by its
+                     liveness bitmap, with branch-free compares for
+                     arithmetic T.
+    ----------------------------------------------------------------------*/
+
+    /***** forEachUnordered *****/
+    template<typename F>
+    void forEachUnordered(F&& visit);
+    template<typename F>
+    void forEachUnordered(F&& visit) const;
+    /*----------------------------------------------------------------------
+      Applies a callable to each element, in no particular order.
+      Precondition:  visit can be called with a T& (const T& for a const list).
+      Postcondition: visit has been applied to each element once. If the
+                     list owns its pool, elements are visited in pool
+                     index order by scanning its liveness bitmap; otherwise
+                     in list order.
     ----------------------------------------------------------------------*/
 
     /***** clear *****/
@@ -125,6 +350,23 @@ public:
       Postcondition: The item is the new first element of the list.
     ----------------------------------------------------------------------*/
 
+    /***** insertFront (move) *****/
+    void insertFront(T&& item);
+    /*----------------------------------------------------------------------
+      Moves an item into a new node at the front of the list.
+      Precondition:  None
+      Postcondition: The item is the new first element of the list.
+    ----------------------------------------------------------------------*/
+
+    /***** emplaceFront *****/
+    template<typename... Args>
+    void emplaceFront(Args&&... args);
+    /*----------------------------------------------------------------------
+      Constructs an item in place at the front of the list.
+      Precondition:  T is constructible from args.
+      Postcondition: The new item is the first element of the list.
+    ----------------------------------------------------------------------*/
+
     /***** deleteFront *****/
     void deleteFront();
     /*----------------------------------------------------------------------
@@ -135,21 +377,89 @@ public:
     ----------------------------------------------------------------------*/
 
     /***** insertAfter *****/
-    void insertAfter(int pos, const T& item);
+    void insertAfter(IndexType pos, const T& item);
     /*----------------------------------------------------------------------
       Inserts an item after a specified position.
       Precondition:  pos is a valid index in the list.
       Postcondition: The item is inserted after the specified position.
-      Throws:        out_of_range if pos is invalid.
+      Throws:        out_of_range if pos is not an allocated node.
+    ----------------------------------------------------------------------*/
+
+    /***** insertAfter (move) *****/
+    void insertAfter(IndexType pos, T&& item);
+    /*----------------------------------------------------------------------
+      Moves an item into a new node after a specified position.
+      Precondition:  pos is a valid index in the list.
+      Postcondition: The item is inserted after the specified position.
+      Throws:        out_of_range if pos is not an allocated node.
+    ----------------------------------------------------------------------*/
+
+    /***** emplaceAfter *****/
+    template<typename... Args>
+    void emplaceAfter(IndexType pos, Args&&... args);
+    /*----------------------------------------------------------------------
+      Constructs an item in place after a specified position.
+      Precondition:  pos is a valid index in the list; T is constructible
+                     from args.
+      Postcondition: The new item is inserted after the specified position.
+      Throws:        out_of_range if pos is not an allocated node.
     ----------------------------------------------------------------------*/
 
     /***** deleteAfter *****/
-    void deleteAfter(int pos);
+    void deleteAfter(IndexType pos);
     /*----------------------------------------------------------------------
       Removes the item after a specified position.
       Precondition:  pos is a valid index with a successor.
       Postcondition: The item after pos is removed from the list.
-      Throws:        out_of_range if pos is invalid or has no successor.
+      Throws:        out_of_range if pos is not an allocated node or has no
+                     successor.
+    ----------------------------------------------------------------------*/
+
+    /***** pushBack *****/
+    void pushBack(const T& item);
+    /*----------------------------------------------------------------------
+      Inserts an item at the end of the list.
+      Precondition:  None
+      Postcondition: The item is added as the last element of the list.
+                     Runs in O(1) using the tracked tail index.
+    ----------------------------------------------------------------------*/
+
+    /***** pushBack (move) *****/
+    void pushBack(T&& item);
+    /*----------------------------------------------------------------------
+      Moves an item into a new node at the end of the list.
+      Precondition:  None
+      Postcondition: The item is added as the last element of the list.
+    ----------------------------------------------------------------------*/
+
+    /***** emplaceBack *****/
+    template<typename... Args>
+    void emplaceBack(Args&&... args);
+    /*----------------------------------------------------------------------
+      Constructs an item in place at the end of the list.
+      Precondition:  T is constructible from args.
+      Postcondition: The new item is the last element of the list.
+    ----------------------------------------------------------------------*/
+
+    /***** append *****/
+    template<typename InputIt>
+    void append(InputIt first, InputIt last);
+    /*----------------------------------------------------------------------
+      Appends the elements of the range [first, last) to the list.
+      Precondition:  [first, last) is a valid range of values convertible to T.
+      Postcondition: The elements have been added after the current last
+                     element, in range order, in a single pass.
+    ----------------------------------------------------------------------*/
+
+    /***** assign *****/
+    template<typename InputIt>
+    void assign(InputIt first, InputIt last);
+    /*----------------------------------------------------------------------
+      Replaces the contents of the list with the range [first, last).
+      Precondition:  [first, last) is a valid range of values convertible to T.
+      Postcondition: The list holds exactly the elements of the range. Nodes
+                     already in the list are reused before new ones are
+                     taken from the pool; surplus nodes are released.
     ----------------------------------------------------------------------*/
 
     /***** insertSorted *****/
@@ -160,22 +470,226 @@ public:
       Postcondition: The item is inserted in the correct sorted position.
     ----------------------------------------------------------------------*/
 
+    /***** insertSorted (move) *****/
+    void insertSorted(T&& item);
+    /*----------------------------------------------------------------------
+      Moves an item into a new node in sorted order (ascending).
+      Precondition:  Type T supports operator<.
+      Postcondition: The item is inserted in the correct sorted position.
+    ----------------------------------------------------------------------*/
+
+    /***** emplaceSorted *****/
+    template<typename... Args>
+    void emplaceSorted(Args&&... args);
+    /*----------------------------------------------------------------------
+      Constructs an item in place, then links it in sorted order (ascending).
+      Precondition:  Type T supports operator< and is constructible from args.
+      Postcondition: The new item is inserted before the first element that
+                     is not less than it.
+    ----------------------------------------------------------------------*/
+
     /***** remove *****/
     bool remove(const T& item);
     /*----------------------------------------------------------------------
       Removes the first occurrence of an item from the list.
       Precondition:  None
       Postcondition: Returns true if item was found and removed, false otherwise.
+                     With the hash index enabled the removal is O(1) on
+                     average and removes the node find(item) reports.
     ----------------------------------------------------------------------*/
 
     /***** getFreeListHead *****/
-    int getFreeListHead() const;
+    IndexType getFreeListHead() const;
     /*----------------------------------------------------------------------
       Returns the index of the first available node in the pool.
       Precondition:  None
       Postcondition: Returns the free list head index or NULL_VALUE if empty.
     ----------------------------------------------------------------------*/
 
+    /***** capacity *****/
+    int capacity() const;
+    /*----------------------------------------------------------------------
+      Returns the number of nodes the list's pool can currently hold.
+      Precondition:  None
+      Postcondition: Returns the pool capacity.
+    ----------------------------------------------------------------------*/
+
+    /***** reserve *****/
+    void reserve(int newCapacity);
+    /*----------------------------------------------------------------------
+      Grows the pool so it can hold at least newCapacity nodes.
+      Precondition:  None
+      Postcondition: capacity() >= newCapacity; existing positions stay valid.
+    ----------------------------------------------------------------------*/
+
+    /***** shrinkToFit *****/
+    void shrinkToFit();
+    /*----------------------------------------------------------------------
+      Releases pool storage past the last node in use.
+      Precondition:  None
+      Postcondition: Unused trailing chunks are freed; positions stay valid.
+    ----------------------------------------------------------------------*/
+
+    /***** compact *****/
+    vector<IndexType> compact();
+    /*----------------------------------------------------------------------
+      Permutes the pool so that the i-th element of the list sits in node
+      i and the free nodes form one contiguous tail, turning a walk of the
+      list into a sequential scan of the pool.
+      Precondition:  The list owns its pool. T is move constructible.
+      Postcondition: Returns the old-to-new mapping, indexed by old
+                     position, with NULL_VALUE for positions that held no
+                     node; callers holding positions remap them through
+                     it. Iterators are invalidated. Runs in O(n + pool
+                     size) and moves each element at most once. A
+                     moved-from list has no pool and gets an empty mapping.
+      Throws:        logic_error if the pool is shared.
+    ----------------------------------------------------------------------*/
+
+    /***** fragmentation *****/
+    double fragmentation() const;
+    /*----------------------------------------------------------------------
+      Measures how scattered the chain is across the pool.
+      Precondition:  None
+      Postcondition: Returns the fraction of links that do not lead to the
+                     next node in the pool, from 0.0 (a compacted list) to
+                     1.0. Runs in O(n).
+    ----------------------------------------------------------------------*/
+
+    /***** setAutoCompact *****/
+    void setAutoCompact(double threshold);
+    /*----------------------------------------------------------------------
+      Makes the list compact itself when fragmentation() exceeds threshold
+      (a value <= 0 turns this off, the default).
+      Precondition:  The list owns its pool. Positions held by callers are
+                     not remapped automatically, so they must not be kept
+                     across an insertFront, pushBack or insertSorted.
+      Postcondition: Once the list has seen as many single-node inserts
+                     and deletes as it holds elements (at least 64), the
+                     next insertFront, pushBack or insertSorted measures
+                     the fragmentation and compacts if it is above
+                     threshold. The check is amortized O(1) per change.
+    ----------------------------------------------------------------------*/
+
+    /***** stats *****/
+    ListStats stats() const;
+    /*----------------------------------------------------------------------
+      Returns a snapshot of the list's counters.
+      Precondition:  None
+      Postcondition: pool holds the pool's counters (shared by every list
+                     on a shared pool) and fragmentation the current
+                     fragmentation(). searches and hops count the calls to
+                     find, insertSorted and remove and the links they
+                     followed, lane links included; they are filled in by
+                     the Stats policy and are 0 with NoStats. O(n), since
+                     the fragmentation is measured.
+    ----------------------------------------------------------------------*/
+
+    /***** splice *****/
+    void splice(IndexType pos, List& other);
+    /*----------------------------------------------------------------------
+      Moves every node of other into this list without copying elements.
+      Precondition:  other draws from the same pool as this list and is a
+                     different list. pos is NULL_VALUE or a node of this list.
+      Postcondition: other's nodes follow pos (or lead the list when pos is
+                     NULL_VALUE) in their original order; other is empty.
+                     Runs in O(1).
+      Throws:        invalid_argument if the lists do not share a pool,
+                     out_of_range if pos is not an allocated node.
+    ----------------------------------------------------------------------*/
+
+    /***** splice (range) *****/
+    void splice(IndexType pos, List& other, IndexType first, IndexType last);
+    /*----------------------------------------------------------------------
+      Moves the nodes of other from first through last into this list
+      without copying elements.
+      Precondition:  other draws from the same pool as this list and is a
+                     different list. first and last are nodes of other,
+                     with last at or after first. pos is NULL_VALUE or a
+                     node of this list.
+      Postcondition: The nodes first..last follow pos (or lead the list
+                     when pos is NULL_VALUE) in their original order and
+                     are gone from other. Runs in O(k) for a range ending
+                     k nodes into other, since the range must be counted
+                     and first's predecessor found.
+      Throws:        invalid_argument if the lists do not share a pool, are
+                     the same list, or first..last is not a range of other,
+                     out_of_range if pos is not an allocated node (both
+                     lists are then unchanged).
+    ----------------------------------------------------------------------*/
+
+    /***** mergeSorted *****/
+    void mergeSorted(List& other);
+    template<typename Compare>
+    void mergeSorted(List& other, Compare comp);
+    /*----------------------------------------------------------------------
+      Merges the elements of other into this list.
+      Precondition:  Both lists are ordered by comp (operator< by default).
+      Postcondition: This list holds both sets of elements ordered by comp,
+                     with its own elements before equal ones from other;
+                     other is empty. If the lists share a pool the nodes
+                     are relinked and no element is copied or moved;
+                     otherwise each element of other is moved into a new
+                     node. Either way runs in O(n + m).
+                     Unless comp is less<T> or less<>, this list's
+                     skip-list lanes are dropped.
+      Throws:        overflow_error if this pool runs out of nodes while
+                     moving; elements moved so far stay in this list and
+                     are removed from other.
+    ----------------------------------------------------------------------*/
+
+    /***** insertSortedRange *****/
+    template<typename InputIt>
+    void insertSortedRange(InputIt first, InputIt last);
+    /*----------------------------------------------------------------------
+      Inserts a batch of elements in sorted order.
+      Precondition:  The list is in ascending order; T supports operator<.
+      Postcondition: The elements of [first, last) have been added and the
+                     list is still in ascending order. The batch is linked
+                     into a chain, merge sorted and merged in one pass:
+                     O(n + k log k) for k elements, instead of k
+                     insertSorted calls of O(n) each.
+      Throws:        overflow_error if the pool runs out of nodes; the
+                     list is then unchanged.
+    ----------------------------------------------------------------------*/
+
+    /***** removeIf *****/
+    template<typename Pred>
+    int removeIf(Pred pred);
+    /*----------------------------------------------------------------------
+      Removes every element for which pred returns true.
+      Precondition:  pred can be called with a T&.
+      Postcondition: The matching nodes have been returned to the pool in
+                     a single traversal. Returns the number removed.
+    ----------------------------------------------------------------------*/
+
+    /***** saveBinary *****/
+    void saveBinary(ostream& out) const;
+    /*----------------------------------------------------------------------
+      Writes the elements in list order as a binary snapshot: a header with
+      a fingerprint of T and the element count, then the raw bytes of each
+      element for trivially copyable T, or a length-prefixed record for
+      std::string.
+      Precondition:  T is trivially copyable or std::string.
+      Postcondition: The snapshot has been written through a fixed-size
+                     buffer. It uses the byte order and type sizes of this
+                     platform.
+      Throws:        runtime_error if the stream fails.
+    ----------------------------------------------------------------------*/
+
+    /***** loadBinary *****/
+    void loadBinary(istream& in);
+    /*----------------------------------------------------------------------
+      Replaces the contents of the list with a snapshot from saveBinary.
+      Precondition:  T is default constructible and trivially copyable, or
+                     std::string.
+      Postcondition: The list holds the snapshot's elements in order. They
+                     are read in bounded memory and appended in O(1) each.
+      Throws:        runtime_error if the stream is not a snapshot for T or
+                     ends early; the list then holds the elements read so far.
+                     overflow_error if the pool runs out of nodes.
+    ----------------------------------------------------------------------*/
+
     /***** printList *****/
     void printList() const;
     /*----------------------------------------------------------------------
@@ -187,242 +701,1825 @@ public:
     void sortList();
     /*----------------------------------------------------------------------
       Sorts the elements of the list in ascending order.
-      Precondition:  None.
-      Postcondition: The list is sorted in ascending order.
+      Precondition:  Type T supports operator<.
+      Postcondition: The list is sorted in ascending order. The sort is
+                     stable and relinks nodes; no element is copied.
+    ----------------------------------------------------------------------*/
+
+    /***** sortList (comparator) *****/
+    template<typename Compare>
+    void sortList(Compare comp);
+    /*----------------------------------------------------------------------
+      Sorts the elements of the list using a bottom-up merge sort.
+      Precondition:  comp(a, b) returns true if a must come before b and
+                     defines a strict weak ordering.
+      Postcondition: The list is ordered by comp. Equal elements keep their
+                     relative order. Runs in O(n log n) by rewiring the
+                     next links; element payloads are never copied or moved.
+                     Unless comp is less<T> or less<>, the skip-list lanes
+                     are dropped, as by disableSortedIndex.
+    ----------------------------------------------------------------------*/
+    /***** enableIndex *****/
+    void enableIndex();
+    /*----------------------------------------------------------------------
+      Builds a hash index from element values to their nodes and keeps it,
+      together with each node's predecessor, in sync on every insert and
+      delete.
+      Precondition:  std::hash<T> is enabled and T supports operator==.
+                     While the index is enabled, elements must not be
+                     modified in place through iterators or forEach.
+      Postcondition: find, contains and remove run in O(1) on average.
+                     Operations that relink many nodes at once (sortList,
+                     splice, assign) rebuild the index in O(n).
+    ----------------------------------------------------------------------*/
+
+    /***** disableIndex *****/
+    void disableIndex();
+    /*----------------------------------------------------------------------
+      Drops the hash index.
+      Precondition:  None
+      Postcondition: The index memory is released; lookups walk the list.
+    ----------------------------------------------------------------------*/
+
+    /***** isIndexed *****/
+    bool isIndexed() const;
+    /*----------------------------------------------------------------------
+      Checks if the hash index is enabled.
+      Precondition:  None
+      Postcondition: Returns true if enableIndex is in effect.
+    ----------------------------------------------------------------------*/
+
+    /***** enableSortedIndex *****/
+    void enableSortedIndex();
+    /*----------------------------------------------------------------------
+      Sorts the list and builds skip-list lanes over it: express lanes of
+      pool-allocated entries that each point at a node of the list and at
+      the entry one lane below. The plain next chain is left untouched.
+      Precondition:  T supports operator<. While the lanes are enabled the
+                     list must stay in ascending order: use insertSorted,
+                     emplaceSorted and the deleting operations, or call
+                     sortList after any other insert.
+      Postcondition: insertSorted, lowerBound, upperBound and
+                     forEachInRange search in O(log n) expected time.
+                     Deleting a node that carries a lane entry costs
+                     O(log n); sortList, splice and assign rebuild the
+                     lanes in O(n).
+    ----------------------------------------------------------------------*/
+
+    /***** disableSortedIndex *****/
+    void disableSortedIndex();
+    /*----------------------------------------------------------------------
+      Drops the skip-list lanes.
+      Precondition:  None
+      Postcondition: The lane memory is released; ordered searches walk
+                     the list.
     ----------------------------------------------------------------------*/
+
+    /***** hasSortedIndex *****/
+    bool hasSortedIndex() const;
+    /*----------------------------------------------------------------------
+      Checks if the skip-list lanes are enabled.
+      Precondition:  None
+      Postcondition: Returns true if enableSortedIndex is in effect.
+    ----------------------------------------------------------------------*/
+
+    /***** lowerBound *****/
+    IndexType lowerBound(const T& item) const;
+    /*----------------------------------------------------------------------
+      Finds the first node whose element is not less than item.
+      Precondition:  The list is in ascending order; T supports operator<.
+      Postcondition: Returns the node index, or NULL_VALUE if every element
+                     is less than item. O(log n) expected with the lanes
+                     enabled, O(n) otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** upperBound *****/
+    IndexType upperBound(const T& item) const;
+    /*----------------------------------------------------------------------
+      Finds the first node whose element is greater than item.
+      Precondition:  The list is in ascending order; T supports operator<.
+      Postcondition: Returns the node index, or NULL_VALUE if no element is
+                     greater than item. O(log n) expected with the lanes
+                     enabled, O(n) otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** forEachInRange *****/
+    template<typename F>
+    void forEachInRange(const T& low, const T& high, F&& visit) const;
+    /*----------------------------------------------------------------------
+      Applies visit to every element e with !(e < low) and e < high.
+      Precondition:  The list is in ascending order; T supports operator<.
+      Postcondition: visit has seen the elements of [low, high) in order.
+                     Costs one lowerBound plus the number of elements
+                     visited.
+    ----------------------------------------------------------------------*/
+
     /***** unique *****/
     void unique();
     /*----------------------------------------------------------------------
       Removes duplicate elements from the list, keeping only first occurrences.
       Precondition:  None
-      Postcondition: List contains no duplicate elements.
+      Postcondition: List contains no duplicate elements; the remaining
+                     elements keep their order. Uses a transient hash set
+                     (O(n)) when std::hash<T> exists, otherwise a stable
+                     sort of node indices (O(n log n)) when T supports
+                     operator<, otherwise pairwise comparison (O(n^2)).
+    ----------------------------------------------------------------------*/
+
+    /***** uniqueAdjacent *****/
+    int uniqueAdjacent();
+    /*----------------------------------------------------------------------
+      Removes every element equal to the element before it.
+      Precondition:  None (on a sorted list this removes all duplicates).
+      Postcondition: No two neighbouring elements are equal. Returns the
+                     number of nodes returned to the pool. Runs in one pass.
     ----------------------------------------------------------------------*/
 
 private:
-    /***** insertBack *****/
-    void insertBack(const T& item);
+    /***** uniqueByHash *****/
+    void uniqueByHash();
+    /***** uniqueByOrder *****/
+    void uniqueByOrder();
+    /***** uniqueByScan *****/
+    void uniqueByScan();
+    /*----------------------------------------------------------------------
+      Strategies for unique: a hash set of the kept elements, a stable sort
+      of node indices that flags later duplicates, or pairwise comparison.
+      Precondition:  The list holds at least two elements.
+      Postcondition: Later duplicates have been removed; order is kept.
+    ----------------------------------------------------------------------*/
+
+    /***** scansPool *****/
+    bool scansPool() const { return ownedPool && pool == ownedPool.get(); }
+    /*----------------------------------------------------------------------
+      Checks if every allocated node of the pool belongs to this list, so
+      the pool can be scanned in place of the chain.
+    ----------------------------------------------------------------------*/
+
+    /***** isAscending *****/
+    template<typename Compare>
+    static constexpr bool isAscending() {
+        return is_same<Compare, less<T>>::value || is_same<Compare, less<>>::value;
+    }
     /*----------------------------------------------------------------------
-      Helper function to insert an item at the end of the list.
+      Checks if ordering by Compare is the ascending order the skip-list
+      lanes index; sortList and mergeSorted drop the lanes otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** sortChain *****/
+    template<typename Compare>
+    void sortChain(IndexType& first, IndexType& last, int length, Compare& comp);
+    /*----------------------------------------------------------------------
+      Helper for sortList: bottom-up merge sort of a chain of nodes.
+      Precondition:  first..last is a NULL_VALUE-terminated chain of length
+                     nodes, length > 0.
+      Postcondition: The chain is relinked in stable comp order; first and
+                     last hold its new ends.
+    ----------------------------------------------------------------------*/
+
+    /***** splitRun *****/
+    IndexType splitRun(IndexType start, int n);
+    /*----------------------------------------------------------------------
+      Helper for sortList: cuts the chain after the first n nodes.
+      Precondition:  start is NULL_VALUE or the first node of a chain.
+      Postcondition: The run beginning at start holds at most n nodes and
+                     ends in NULL_VALUE. Returns the first node after the
+                     run (NULL_VALUE if none).
+    ----------------------------------------------------------------------*/
+
+    /***** mergeRuns *****/
+    template<typename Compare>
+    void mergeRuns(IndexType left, IndexType right, Compare& comp, IndexType& first, IndexType& last);
+    /*----------------------------------------------------------------------
+      Helper for sortList: merges two sorted, NULL_VALUE-terminated runs.
+      Precondition:  At least one run is non-empty; both are ordered by comp.
+      Postcondition: first and last hold the ends of the merged run. Nodes
+                     from left win ties, which keeps the sort stable.
+    ----------------------------------------------------------------------*/
+
+    /***** allocNode *****/
+    template<typename... Args>
+    IndexType allocNode(Args&&... args);
+    /*----------------------------------------------------------------------
+      Allocates a node holding a T constructed from args.
       Precondition:  None
-      Postcondition: The item is added as the last element of the list.
+      Postcondition: Returns the index of the new, unlinked node. A list
+                     left without a pool by a move gets a default pool first.
+    ----------------------------------------------------------------------*/
+
+    /***** assignNodes *****/
+    template<typename InputIt>
+    void assignNodes(InputIt first, InputIt last);
+    /*----------------------------------------------------------------------
+      Helper for assign: overwrites, releases or appends nodes.
+      Precondition:  The hash index and the lanes are detached.
+      Postcondition: The list holds exactly the elements of [first, last).
+    ----------------------------------------------------------------------*/
+
+    /***** indexLinked *****/
+    void indexLinked(IndexType idx, IndexType prev);
+    /*----------------------------------------------------------------------
+      Index hook called after node idx has been linked in after prev
+      (NULL_VALUE when idx is the new head).
+      Precondition:  idx is linked into this list.
+      Postcondition: If the index is enabled, idx is in the value map and
+                     the predecessors of idx and of its successor are set.
+    ----------------------------------------------------------------------*/
+
+    /***** indexUnlinking *****/
+    void indexUnlinking(IndexType idx, IndexType prev);
+    /*----------------------------------------------------------------------
+      Index hook called before node idx, which follows prev (NULL_VALUE when
+      idx is the head), is unlinked and deleted.
+      Precondition:  idx is still linked into this list.
+      Postcondition: If the index is enabled, idx is out of the value map
+                     and its successor's predecessor is prev.
+    ----------------------------------------------------------------------*/
+
+    /***** rebuildIndex *****/
+    void rebuildIndex();
+    /*----------------------------------------------------------------------
+      Recomputes the value map and the predecessors from the chain.
+      Precondition:  None
+      Postcondition: If the index is enabled, it matches the list exactly.
+    ----------------------------------------------------------------------*/
+
+    /***** maybeCompact *****/
+    void maybeCompact();
+    /*----------------------------------------------------------------------
+      Runs the automatic compaction check set up by setAutoCompact.
+      Precondition:  No position into this list is held by the caller.
+      Postcondition: The list has been compacted if it was due and too
+                     fragmented.
+    ----------------------------------------------------------------------*/
+
+    /***** laneDescend *****/
+    IndexType laneDescend(const T& item, bool inclusive, IndexType* update, long long* hops = nullptr) const;
+    /*----------------------------------------------------------------------
+      Walks the skip-list lanes from the top level down.
+      Precondition:  The lanes are enabled. update is null or has room for
+                     MAX_LANES entries.
+      Postcondition: Returns the last bottom-lane entry whose node is
+                     before item (less than item, or not greater than item
+                     when inclusive), NULL_VALUE if none. update[level]
+                     receives the same entry for every level. hops, if
+                     not null, grows by the lane links followed.
+    ----------------------------------------------------------------------*/
+
+    /***** orderedSearch *****/
+    IndexType orderedSearch(const T& item, bool inclusive, IndexType* update, long long* hops = nullptr) const;
+    /*----------------------------------------------------------------------
+      Finds the last node before item, using the lanes when enabled.
+      Precondition:  The list is in ascending order.
+      Postcondition: Returns that node, or NULL_VALUE if item goes before
+                     the head. update is filled as in laneDescend and
+                     hops grows by every link followed.
+    ----------------------------------------------------------------------*/
+
+    /***** laneLinked *****/
+    void laneLinked(IndexType idx, const IndexType* update);
+    /*----------------------------------------------------------------------
+      Gives the newly linked node idx a tower of random height.
+      Precondition:  The lanes are enabled; update came from laneDescend
+                     for idx's element.
+      Postcondition: idx appears in each lane of its tower, in order.
     ----------------------------------------------------------------------*/
 
-    NodePool<T, NUM_NODES> pool;  // Node pool for memory management
-    int head;                     // Index of the first node in the list
+    /***** laneUnlinking *****/
+    void laneUnlinking(IndexType idx);
+    /*----------------------------------------------------------------------
+      Lane hook called before node idx is unlinked and deleted.
+      Precondition:  idx is still linked into this list.
+      Postcondition: If the lanes are enabled, no lane refers to idx.
+    ----------------------------------------------------------------------*/
+
+    /***** rebuildLanes *****/
+    void rebuildLanes();
+    /*----------------------------------------------------------------------
+      Discards the lanes and rebuilds them from the chain in one pass.
+      Precondition:  None
+      Postcondition: If the lanes are enabled, they match the list.
+    ----------------------------------------------------------------------*/
+
+    // NodeIndex maps element values (by pointer into the pool) to nodes
+    struct IndexHash {
+        size_t operator()(const T* p) const { return hash<T>()(*p); }
+    };
+    struct IndexEqual {
+        bool operator()(const T* a, const T* b) const { return *a == *b; }
+    };
+    struct NodeIndex {
+        unordered_multimap<const T*, IndexType, IndexHash, IndexEqual> nodes;  // Value to node
+        vector<IndexType> prev;   // Predecessor of each linked node, by node index
+    };
+
+    // SkipLanes holds the express lanes of the sorted index. Each lane entry
+    // names a node of the list and the entry for the same node one level down
+    static const int MAX_LANES = 16;  // Enough for 4^16 nodes at p = 1/4
+    struct LaneEntry {
+        IndexType node;           // List node this entry stands for
+        IndexType down;           // Entry one level down (NULL_VALUE at level 0)
+    };
+    struct SkipLanes {
+        NodePool<LaneEntry, NUM_NODES, Layout, IndexType> entries;
+        IndexType heads[MAX_LANES];      // First entry of each lane
+        vector<unsigned char> height;    // Tower height of each node, by node index
+        uint32_t seed;                   // xorshift state for tower heights
+
+        SkipLanes() : entries(1, true), height(), seed(0x9E3779B9u) {
+            for (int level = 0; level < MAX_LANES; ++level)
+                heads[level] = NULL_VALUE;
+        }
+        int randomHeight() {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            // Each pair of bits promotes the node one more level with p = 1/4
+            uint32_t bits = seed;
+            int h = 0;
+            while (h < MAX_LANES && (bits & 3u) == 0) {
+                ++h;
+                bits >>= 2;
+            }
+            return h;
+        }
+    };
+
+    // A binary snapshot starts with SNAPSHOT_MAGIC, SNAPSHOT_VERSION, the
+    // element size (0 for strings), the type fingerprint and the element count
+    static const uint32_t SNAPSHOT_MAGIC = 0x5453494C;  // "LIST"
+    static const uint32_t SNAPSHOT_VERSION = 2;
+    static const int SNAPSHOT_BUFFER = 4096;  // Bytes staged per stream call
+
+    /***** snapshotFingerprint *****/
+    static uint64_t snapshotFingerprint();
+    /*----------------------------------------------------------------------
+      Identifies T in a snapshot by hashing its type name, size and
+      alignment, so a snapshot of another type of the same size is refused.
+    ----------------------------------------------------------------------*/
+    static const int FIND_BATCH = 16;  // Keys per walk in findMany without hashing
+
+    unique_ptr<PoolType> ownedPool;  // Pool owned by this list (null when shared)
+    PoolType* pool;               // Node pool for memory management
+    IndexType head;               // Index of the first node in the list
+    IndexType tail;               // Index of the last node in the list
+    int count;                    // Number of elements in the list
+    unique_ptr<NodeIndex> nodeIndex;  // Hash index (null unless enabled)
+    unique_ptr<SkipLanes> sortedLanes;  // Skip-list lanes (null unless enabled)
+    double autoCompactAt;         // Fragmentation that triggers compact (<= 0: off)
+    int churn;                    // Single-node inserts and deletes since the last check
 };
 
 // Implementation
 
-template<typename T, int NUM_NODES>
-List<T, NUM_NODES>::List() : pool(), head(NULL_VALUE) {}
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::NULL_VALUE;
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const int List<T, NUM_NODES, Layout, IndexType, Stats>::MAX_LANES;
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+List<T, NUM_NODES, Layout, IndexType, Stats>::List()
+    : ownedPool(new PoolType()), pool(ownedPool.get()),
+      head(NULL_VALUE), tail(NULL_VALUE), count(0), autoCompactAt(0), churn(0) {}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+List<T, NUM_NODES, Layout, IndexType, Stats>::List(int initialCapacity, bool growable)
+    : ownedPool(new PoolType(initialCapacity, growable)), pool(ownedPool.get()),
+      head(NULL_VALUE), tail(NULL_VALUE), count(0), autoCompactAt(0), churn(0) {}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+List<T, NUM_NODES, Layout, IndexType, Stats>::List(PoolType& sharedPool)
+    : ownedPool(), pool(&sharedPool), head(NULL_VALUE), tail(NULL_VALUE), count(0),
+      autoCompactAt(0), churn(0) {}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+List<T, NUM_NODES, Layout, IndexType, Stats>::List(const List& other)
+    : Stats(),
+      ownedPool(other.ownedPool
+                    ? new PoolType(other.pool->capacity(), other.pool->isGrowable())
+                    : nullptr),
+      pool(other.ownedPool ? ownedPool.get() : other.pool),
+      head(NULL_VALUE), tail(NULL_VALUE), count(0), autoCompactAt(other.autoCompactAt), churn(0) {
+    if constexpr (IsHashable<T>::value) {
+        if (other.nodeIndex)
+            enableIndex();
+    }
+    append(other.begin(), other.end());
+    if constexpr (IsOrdered<T>::value) {
+        if (other.sortedLanes)
+            enableSortedIndex();
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+List<T, NUM_NODES, Layout, IndexType, Stats>& List<T, NUM_NODES, Layout, IndexType, Stats>::operator=(const List& other) {
+    if (this != &other) {
+        assign(other.begin(), other.end());
+    }
+    return *this;
+}
 
-template<typename T, int NUM_NODES>
-List<T, NUM_NODES>::List(const List& other) : pool(), head(NULL_VALUE) {
-    other.traverse([this](const T& v){ insertBack(v); });
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+List<T, NUM_NODES, Layout, IndexType, Stats>::List(List&& other) noexcept
+    : Stats(std::move(static_cast<Stats&>(other))), ownedPool(std::move(other.ownedPool)), pool(other.pool),
+      head(other.head), tail(other.tail), count(other.count),
+      nodeIndex(std::move(other.nodeIndex)), sortedLanes(std::move(other.sortedLanes)),
+      autoCompactAt(other.autoCompactAt), churn(other.churn) {
+    if (ownedPool)
+        other.pool = nullptr;
+    other.head = other.tail = NULL_VALUE;
+    other.count = 0;
+    static_cast<Stats&>(other) = Stats();
 }
 
-template<typename T, int NUM_NODES>
-List<T, NUM_NODES>& List<T, NUM_NODES>::operator=(const List& other) {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+List<T, NUM_NODES, Layout, IndexType, Stats>& List<T, NUM_NODES, Layout, IndexType, Stats>::operator=(List&& other) noexcept {
     if (this != &other) {
+        // Drop the index and lanes first: clear would rebuild them, which allocates
+        nodeIndex.reset();
+        sortedLanes.reset();
         clear();
-        other.traverse([this](const T& v){ insertBack(v); });
+        bool otherOwnsPool = (other.ownedPool != nullptr);
+        ownedPool = std::move(other.ownedPool);
+        pool = other.pool;
+        head = other.head;
+        tail = other.tail;
+        count = other.count;
+        nodeIndex = std::move(other.nodeIndex);
+        sortedLanes = std::move(other.sortedLanes);
+        autoCompactAt = other.autoCompactAt;
+        churn = other.churn;
+        static_cast<Stats&>(*this) = std::move(static_cast<Stats&>(other));
+        if (otherOwnsPool)
+            other.pool = nullptr;
+        other.head = other.tail = NULL_VALUE;
+        other.count = 0;
+        static_cast<Stats&>(other) = Stats();
     }
     return *this;
 }
 
-template<typename T, int NUM_NODES>
-List<T, NUM_NODES>::~List() {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+List<T, NUM_NODES, Layout, IndexType, Stats>::~List() {
+    nodeIndex.reset();
+    sortedLanes.reset();
     clear();
 }
 
-template<typename T, int NUM_NODES>
-bool List<T, NUM_NODES>::isEmpty() const {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+bool List<T, NUM_NODES, Layout, IndexType, Stats>::isEmpty() const {
     return head == NULL_VALUE;
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::traverse(const function<void(const T&)>& visit) const {
-    int ptr = head;
-    while (ptr != NULL_VALUE) {
-        visit(pool.data()[ptr].data);
-        ptr = pool.data()[ptr].next;
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::traverse(const function<void(const T&)>& visit) const {
+    forEach(visit);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename F>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::forEach(F&& visit) {
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr))
+        visit(pool->value(ptr));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename F>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::forEach(F&& visit) const {
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr))
+        visit(pool->value(ptr));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+typename List<T, NUM_NODES, Layout, IndexType, Stats>::iterator List<T, NUM_NODES, Layout, IndexType, Stats>::begin() {
+    return iterator(pool, head);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+typename List<T, NUM_NODES, Layout, IndexType, Stats>::iterator List<T, NUM_NODES, Layout, IndexType, Stats>::end() {
+    return iterator(pool, NULL_VALUE);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+typename List<T, NUM_NODES, Layout, IndexType, Stats>::const_iterator List<T, NUM_NODES, Layout, IndexType, Stats>::begin() const {
+    return const_iterator(pool, head);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+typename List<T, NUM_NODES, Layout, IndexType, Stats>::const_iterator List<T, NUM_NODES, Layout, IndexType, Stats>::end() const {
+    return const_iterator(pool, NULL_VALUE);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+typename List<T, NUM_NODES, Layout, IndexType, Stats>::const_iterator List<T, NUM_NODES, Layout, IndexType, Stats>::cbegin() const {
+    return begin();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+typename List<T, NUM_NODES, Layout, IndexType, Stats>::const_iterator List<T, NUM_NODES, Layout, IndexType, Stats>::cend() const {
+    return end();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+int List<T, NUM_NODES, Layout, IndexType, Stats>::size() const {
+    return count;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::find(const T& item) const {
+    if constexpr (IsHashable<T>::value) {
+        if (nodeIndex) {
+            this->onSearch(ListStats::FIND, 0);
+            auto it = nodeIndex->nodes.find(&item);
+            return it == nodeIndex->nodes.end() ? NULL_VALUE : it->second;
+        }
+    }
+    IndexType ptr = head;
+    long long links = 0;
+    while (ptr != NULL_VALUE && !(pool->value(ptr) == item)) {
+        ptr = pool->next(ptr);
+        ++links;
     }
+    this->onSearch(ListStats::FIND, links);
+    return ptr;
 }
 
-template<typename T, int NUM_NODES>
-int List<T, NUM_NODES>::size() const {
-    int count = 0, ptr = head;
-    while (ptr != NULL_VALUE) {
-        ++count;
-        ptr = pool.data()[ptr].next;
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::findMany(const T* keys, int n, IndexType* out) const {
+    for (int i = 0; i < n; ++i)
+        out[i] = NULL_VALUE;
+    if (n <= 0 || isEmpty())
+        return;
+    if constexpr (IsHashable<T>::value) {
+        if (nodeIndex) {
+            for (int i = 0; i < n; ++i)
+                out[i] = find(keys[i]);
+            return;
+        }
+        // Map each distinct key to its first slot; repeated keys are chained
+        unordered_map<const T*, int, IndexHash, IndexEqual> pending;
+        vector<int> sameKey(n, -1);
+        for (int i = n - 1; i >= 0; --i) {
+            auto placed = pending.emplace(&keys[i], i);
+            if (!placed.second) {
+                sameKey[i] = placed.first->second;
+                placed.first->second = i;
+            }
+        }
+        for (IndexType ptr = head; ptr != NULL_VALUE && !pending.empty(); ptr = pool->next(ptr)) {
+            auto it = pending.find(&pool->value(ptr));
+            if (it != pending.end()) {
+                for (int i = it->second; i >= 0; i = sameKey[i])
+                    out[i] = ptr;
+                pending.erase(it);
+            }
+        }
+    } else {
+        for (int first = 0; first < n; first += FIND_BATCH) {
+            int last = first + FIND_BATCH < n ? first + FIND_BATCH : n;
+            int missing = last - first;
+            for (IndexType ptr = head; ptr != NULL_VALUE && missing > 0; ptr = pool->next(ptr)) {
+                const T& v = pool->value(ptr);
+                for (int i = first; i < last; ++i) {
+                    if (out[i] == NULL_VALUE && v == keys[i]) {
+                        out[i] = ptr;
+                        --missing;
+                    }
+                }
+            }
+        }
     }
-    return count;
 }
 
-template<typename T, int NUM_NODES>
-int List<T, NUM_NODES>::find(const T& item) const {
-    int ptr = head;
-    while (ptr != NULL_VALUE) {
-        if (pool.data()[ptr].data == item) return ptr;
-        ptr = pool.data()[ptr].next;
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+bool List<T, NUM_NODES, Layout, IndexType, Stats>::contains(const T& item) const {
+    if constexpr (IsHashable<T>::value) {
+        if (nodeIndex)
+            return find(item) != NULL_VALUE;
+    }
+    if (!scansPool())
+        return find(item) != NULL_VALUE;
+    int words = pool->liveWords();
+    for (int w = 0; w < words; ++w) {
+        if (pool->matchLive(w, [&item](const T& v) { return v == item; }))
+            return true;
+    }
+    return false;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+int List<T, NUM_NODES, Layout, IndexType, Stats>::countOf(const T& item) const {
+    int n = 0;
+    if (!scansPool()) {
+        forEach([&](const T& v) { if (v == item) ++n; });
+        return n;
+    }
+    int words = pool->liveWords();
+    for (int w = 0; w < words; ++w) {
+        uint64_t hits = pool->matchLive(w, [&item](const T& v) { return v == item; });
+        for (; hits != 0; hits &= hits - 1)
+            ++n;
     }
-    return NULL_VALUE;
+    return n;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename F>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::forEachUnordered(F&& visit) {
+    if (scansPool())
+        pool->forEachLive(visit);
+    else
+        forEach(visit);
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::clear() {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename F>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::forEachUnordered(F&& visit) const {
+    if (scansPool())
+        static_cast<const PoolType*>(pool)->forEachLive(visit);
+    else
+        forEach(visit);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::clear() {
+    // Detach the lanes so deleting node by node does not search them
+    unique_ptr<SkipLanes> savedLanes(std::move(sortedLanes));
     while (!isEmpty()) deleteFront();
+    sortedLanes = std::move(savedLanes);
+    rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::insertFront(const T& item) {
+    emplaceFront(item);
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::insertFront(const T& item) {
-    int idx = pool.newNode();
-    pool.data()[idx].data = item;
-    pool.data()[idx].next = head;
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::insertFront(T&& item) {
+    emplaceFront(std::move(item));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename... Args>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::emplaceFront(Args&&... args) {
+    maybeCompact();
+    IndexType idx = allocNode(std::forward<Args>(args)...);
+    pool->next(idx) = head;
     head = idx;
+    if (tail == NULL_VALUE)
+        tail = idx;
+    ++count;
+    ++churn;
+    indexLinked(idx, NULL_VALUE);
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::deleteFront() {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::deleteFront() {
     if (isEmpty())
         throw underflow_error("List::deleteFront() on empty list");
-    int old = head;
-    head = pool.data()[old].next;
-    pool.deleteNode(old);
+    IndexType old = head;
+    indexUnlinking(old, NULL_VALUE);
+    laneUnlinking(old);
+    head = pool->next(old);
+    if (head == NULL_VALUE)
+        tail = NULL_VALUE;
+    pool->deleteNode(old);
+    --count;
+    ++churn;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::insertAfter(IndexType pos, const T& item) {
+    emplaceAfter(pos, item);
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::insertAfter(int pos, const T& item) {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::insertAfter(IndexType pos, T&& item) {
+    emplaceAfter(pos, std::move(item));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename... Args>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::emplaceAfter(IndexType pos, Args&&... args) {
         if (isEmpty()) {
             throw underflow_error("List::insertAfter() on empty list ");
         }
-    if (pos == NULL_VALUE || pos < 0 || pos >= NUM_NODES)
+    if (!pool->isLive(pos))
         throw out_of_range("List::insertAfter invalid position");
-    int idx = pool.newNode();
-    pool.data()[idx].data = item;
-    pool.data()[idx].next = pool.data()[pos].next;
-    pool.data()[pos].next = idx;
+    IndexType idx = allocNode(std::forward<Args>(args)...);
+    pool->next(idx) = pool->next(pos);
+    pool->next(pos) = idx;
+    if (pos == tail)
+        tail = idx;
+    ++count;
+    ++churn;
+    indexLinked(idx, pos);
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::deleteAfter(int pos) {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::deleteAfter(IndexType pos) {
     if (isEmpty()) {
         throw underflow_error("List::deleteAfter() on empty list");
     }
-    if (pos == NULL_VALUE || pos < 0 || pos >= NUM_NODES)
+    if (!pool->isLive(pos))
         throw out_of_range("List::deleteAfter invalid position");
-    int tgt = pool.data()[pos].next;
+    IndexType tgt = pool->next(pos);
     if (tgt == NULL_VALUE)
         throw out_of_range("List::deleteAfter no successor");
-    pool.data()[pos].next = pool.data()[tgt].next;
-    pool.deleteNode(tgt);
+    indexUnlinking(tgt, pos);
+    laneUnlinking(tgt);
+    pool->next(pos) = pool->next(tgt);
+    if (tgt == tail)
+        tail = pos;
+    pool->deleteNode(tgt);
+    --count;
+    ++churn;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::pushBack(const T& item) {
+    emplaceBack(item);
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::insertBack(const T& item) {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::pushBack(T&& item) {
+    emplaceBack(std::move(item));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename... Args>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::emplaceBack(Args&&... args) {
+    maybeCompact();
+    IndexType idx = allocNode(std::forward<Args>(args)...);
+    IndexType prev = tail;
     if (isEmpty())
-        insertFront(item);
-    else {
-        int ptr = head;
-        while (pool.data()[ptr].next != NULL_VALUE)
-            ptr = pool.data()[ptr].next;
-        insertAfter(ptr, item);
-    }
-}
-
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::insertSorted(const T& item) {
-    if (isEmpty() || item < pool.data()[head].data)
-        insertFront(item);
-    else {
-        int prev = head, curr = pool.data()[prev].next;
-        while (curr != NULL_VALUE && pool.data()[curr].data < item) {
-            prev = curr;
-            curr = pool.data()[prev].next;
+        head = idx;
+    else
+        pool->next(tail) = idx;
+    tail = idx;
+    ++count;
+    ++churn;
+    indexLinked(idx, prev);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename InputIt>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::append(InputIt first, InputIt last) {
+    for (; first != last; ++first)
+        pushBack(*first);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename InputIt>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::assign(InputIt first, InputIt last) {
+    // Elements are overwritten in place, so the index is rebuilt afterwards
+    unique_ptr<NodeIndex> savedIndex(std::move(nodeIndex));
+    unique_ptr<SkipLanes> savedLanes(std::move(sortedLanes));
+    try {
+        assignNodes(first, last);
+    } catch (...) {
+        nodeIndex = std::move(savedIndex);
+        sortedLanes = std::move(savedLanes);
+        rebuildIndex();
+        rebuildLanes();
+        throw;
+    }
+    nodeIndex = std::move(savedIndex);
+    sortedLanes = std::move(savedLanes);
+    rebuildIndex();
+    rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename InputIt>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::assignNodes(InputIt first, InputIt last) {
+    IndexType prev = NULL_VALUE, ptr = head;
+    while (ptr != NULL_VALUE && first != last) {
+        pool->value(ptr) = *first;
+        prev = ptr;
+        ptr = pool->next(ptr);
+        ++first;
+    }
+    if (ptr != NULL_VALUE) {
+        // Release the surplus nodes past the last reused one
+        if (prev == NULL_VALUE) {
+            clear();
+        } else {
+            while (pool->next(prev) != NULL_VALUE)
+                deleteAfter(prev);
         }
-        insertAfter(prev, item);
+    } else {
+        append(first, last);
     }
 }
 
-template<typename T, int NUM_NODES>
-bool List<T, NUM_NODES>::remove(const T& item) {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::insertSorted(const T& item) {
+    emplaceSorted(item);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::insertSorted(T&& item) {
+    emplaceSorted(std::move(item));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename... Args>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::emplaceSorted(Args&&... args) {
+    maybeCompact();
+    IndexType idx = allocNode(std::forward<Args>(args)...);
+    const T& item = pool->value(idx);
+    IndexType prev = NULL_VALUE;
+    if (sortedLanes) {
+        IndexType update[MAX_LANES];
+        long long links = 0;
+        try {
+            prev = orderedSearch(item, false, update, Stats::ENABLED ? &links : nullptr);
+        } catch (...) {
+            pool->deleteNode(idx);
+            throw;
+        }
+        IndexType curr = (prev == NULL_VALUE) ? head : pool->next(prev);
+        pool->next(idx) = curr;
+        if (prev == NULL_VALUE)
+            head = idx;
+        else
+            pool->next(prev) = idx;
+        if (curr == NULL_VALUE)
+            tail = idx;
+        ++count;
+        ++churn;
+        laneLinked(idx, update);
+        indexLinked(idx, prev);
+        this->onSearch(ListStats::INSERT_SORTED, links);
+        return;
+    }
+    long long links = 0;
+    try {
+        if (isEmpty() || item < pool->value(head)) {
+            pool->next(idx) = head;
+            head = idx;
+            if (tail == NULL_VALUE)
+                tail = idx;
+        } else {
+            prev = head;
+            IndexType curr = pool->next(prev);
+            while (curr != NULL_VALUE && pool->value(curr) < item) {
+                prev = curr;
+                curr = pool->next(prev);
+                ++links;
+            }
+            pool->next(idx) = curr;
+            pool->next(prev) = idx;
+            if (prev == tail)
+                tail = idx;
+        }
+    } catch (...) {
+        pool->deleteNode(idx);
+        throw;
+    }
+    ++count;
+    ++churn;
+    indexLinked(idx, prev);
+    this->onSearch(ListStats::INSERT_SORTED, links);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+bool List<T, NUM_NODES, Layout, IndexType, Stats>::remove(const T& item) {
     if (isEmpty()) return false;
-    if (pool.data()[head].data == item) {
+    if constexpr (IsHashable<T>::value) {
+        if (nodeIndex) {
+            this->onSearch(ListStats::REMOVE, 0);
+            auto it = nodeIndex->nodes.find(&item);
+            if (it == nodeIndex->nodes.end()) return false;
+            IndexType idx = it->second;
+            IndexType prev = nodeIndex->prev[idx];
+            if (prev == NULL_VALUE)
+                deleteFront();
+            else
+                deleteAfter(prev);
+            return true;
+        }
+    }
+    if (pool->value(head) == item) {
+        this->onSearch(ListStats::REMOVE, 0);
         deleteFront();
         return true;
     }
-    int prev = head, curr = pool.data()[prev].next;
-    while (curr != NULL_VALUE && pool.data()[curr].data != item) {
+    IndexType prev = head, curr = pool->next(prev);
+    long long links = 1;
+    while (curr != NULL_VALUE && pool->value(curr) != item) {
         prev = curr;
-        curr = pool.data()[prev].next;
+        curr = pool->next(prev);
+        ++links;
     }
+    this->onSearch(ListStats::REMOVE, links);
     if (curr == NULL_VALUE) return false;
     deleteAfter(prev);
     return true;
 }
 
-template<typename T, int NUM_NODES>
-int List<T, NUM_NODES>::getFreeListHead() const {
-    return pool.getFreeListHead();
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename... Args>
+IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::allocNode(Args&&... args) {
+    if (!pool) {
+        ownedPool.reset(new PoolType());
+        pool = ownedPool.get();
+    }
+    return pool->newNode(std::forward<Args>(args)...);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::getFreeListHead() const {
+    return pool ? pool->getFreeListHead() : NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+int List<T, NUM_NODES, Layout, IndexType, Stats>::capacity() const {
+    return pool ? pool->capacity() : 0;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::reserve(int newCapacity) {
+    if (!pool) {
+        ownedPool.reset(new PoolType(newCapacity > 0 ? newCapacity : NUM_NODES));
+        pool = ownedPool.get();
+    }
+    pool->reserve(newCapacity);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::shrinkToFit() {
+    if (pool)
+        pool->shrinkToFit();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+vector<IndexType> List<T, NUM_NODES, Layout, IndexType, Stats>::compact() {
+    if (!pool)
+        return vector<IndexType>();  // Moved from: no pool, nothing to remap
+    if (!ownedPool)
+        throw logic_error("List::compact on a shared pool");
+    vector<IndexType> order;
+    order.reserve(count);
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr))
+        order.push_back(ptr);
+    vector<IndexType> remap = pool->compact(order);
+    head = count > 0 ? 0 : NULL_VALUE;
+    tail = count > 0 ? static_cast<IndexType>(count - 1) : NULL_VALUE;
+    churn = 0;
+    // Elements moved, so the hash index keys and the lanes are stale
+    rebuildIndex();
+    rebuildLanes();
+    return remap;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+double List<T, NUM_NODES, Layout, IndexType, Stats>::fragmentation() const {
+    if (count < 2)
+        return 0.0;
+    int jumps = 0;
+    for (IndexType ptr = head; pool->next(ptr) != NULL_VALUE; ptr = pool->next(ptr)) {
+        if (static_cast<long long>(pool->next(ptr)) != static_cast<long long>(ptr) + 1)
+            ++jumps;
+    }
+    return static_cast<double>(jumps) / (count - 1);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+ListStats List<T, NUM_NODES, Layout, IndexType, Stats>::stats() const {
+    ListStats s = ListStats();
+    if (pool)
+        s.pool = pool->stats();
+    this->fillList(s);
+    s.fragmentation = fragmentation();
+    return s;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::setAutoCompact(double threshold) {
+    autoCompactAt = threshold;
+    churn = 0;
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::printList() const {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::maybeCompact() {
+    if (autoCompactAt <= 0 || !ownedPool || churn < max(count, 64))
+        return;
+    churn = 0;
+    if (fragmentation() > autoCompactAt)
+        compact();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::splice(IndexType pos, List& other) {
+    if (pool != other.pool)
+        throw invalid_argument("List::splice lists do not share a pool");
+    if (this == &other || other.isEmpty())
+        return;
+    if (pos == NULL_VALUE) {
+        pool->next(other.tail) = head;
+        head = other.head;
+        if (tail == NULL_VALUE)
+            tail = other.tail;
+    } else {
+        if (!pool->isLive(pos))
+            throw out_of_range("List::splice invalid position");
+        pool->next(other.tail) = pool->next(pos);
+        pool->next(pos) = other.head;
+        if (pos == tail)
+            tail = other.tail;
+    }
+    count += other.count;
+    other.head = other.tail = NULL_VALUE;
+    other.count = 0;
+    rebuildIndex();
+    other.rebuildIndex();
+    rebuildLanes();
+    other.rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::splice(IndexType pos, List& other, IndexType first, IndexType last) {
+    if (pool != other.pool)
+        throw invalid_argument("List::splice lists do not share a pool");
+    if (this == &other)
+        throw invalid_argument("List::splice range must come from another list");
+    if (pos != NULL_VALUE && !pool->isLive(pos))
+        throw out_of_range("List::splice invalid position");
+
+    // Find the node before first, then count the range up to last
+    IndexType before = NULL_VALUE, ptr = other.head;
+    while (ptr != NULL_VALUE && ptr != first) {
+        before = ptr;
+        ptr = pool->next(ptr);
+    }
+    int moved = 0;
+    while (ptr != NULL_VALUE) {
+        ++moved;
+        if (ptr == last)
+            break;
+        ptr = pool->next(ptr);
+    }
+    if (ptr == NULL_VALUE)
+        throw invalid_argument("List::splice first..last is not a range of the other list");
+
+    IndexType after = pool->next(last);
+    if (before == NULL_VALUE)
+        other.head = after;
+    else
+        pool->next(before) = after;
+    if (other.tail == last)
+        other.tail = before;
+    other.count -= moved;
+
+    if (pos == NULL_VALUE) {
+        pool->next(last) = head;
+        head = first;
+        if (tail == NULL_VALUE)
+            tail = last;
+    } else {
+        pool->next(last) = pool->next(pos);
+        pool->next(pos) = first;
+        if (pos == tail)
+            tail = last;
+    }
+    count += moved;
+    rebuildIndex();
+    other.rebuildIndex();
+    rebuildLanes();
+    other.rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::mergeSorted(List& other) {
+    mergeSorted(other, less<T>());
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename Compare>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::mergeSorted(List& other, Compare comp) {
+    if (this == &other || other.isEmpty())
+        return;
+    if (!isAscending<Compare>())
+        sortedLanes.reset();
+    if (pool == other.pool) {
+        IndexType first, last;
+        mergeRuns(head, other.head, comp, first, last);
+        head = first;
+        tail = last;
+        count += other.count;
+        other.head = other.tail = NULL_VALUE;
+        other.count = 0;
+    } else {
+        // Separate pools: move each element of other into a node linked in
+        // at its place, walking both lists once
+        IndexType prev = NULL_VALUE, curr = head, src = other.head;
+        try {
+            for (; src != NULL_VALUE; src = other.pool->next(src)) {
+                T& item = other.pool->value(src);
+                while (curr != NULL_VALUE && !comp(item, pool->value(curr))) {
+                    prev = curr;
+                    curr = pool->next(curr);
+                }
+                IndexType idx = allocNode(std::move(item));
+                pool->next(idx) = curr;
+                if (prev == NULL_VALUE)
+                    head = idx;
+                else
+                    pool->next(prev) = idx;
+                if (curr == NULL_VALUE)
+                    tail = idx;
+                prev = idx;
+                ++count;
+                ++churn;
+            }
+        } catch (...) {
+            while (other.head != src)
+                other.deleteFront();
+            rebuildIndex();
+            rebuildLanes();
+            throw;
+        }
+        other.clear();
+    }
+    rebuildIndex();
+    other.rebuildIndex();
+    rebuildLanes();
+    other.rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename InputIt>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::insertSortedRange(InputIt first, InputIt last) {
+    IndexType runHead = NULL_VALUE, runTail = NULL_VALUE;
+    int n = 0;
+    try {
+        for (; first != last; ++first) {
+            IndexType idx = allocNode(*first);
+            if (runHead == NULL_VALUE)
+                runHead = idx;
+            else
+                pool->next(runTail) = idx;
+            runTail = idx;
+            ++n;
+        }
+    } catch (...) {
+        while (runHead != NULL_VALUE) {
+            IndexType following = pool->next(runHead);
+            pool->deleteNode(runHead);
+            runHead = following;
+        }
+        throw;
+    }
+    if (n == 0)
+        return;
+
+    less<T> comp;
+    sortChain(runHead, runTail, n, comp);
+    IndexType newHead, newTail;
+    mergeRuns(head, runHead, comp, newHead, newTail);
+    head = newHead;
+    tail = newTail;
+    count += n;
+    churn += n;
+    rebuildIndex();
+    rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename Pred>
+int List<T, NUM_NODES, Layout, IndexType, Stats>::removeIf(Pred pred) {
+    // Nodes are unlinked directly, so the index is rebuilt afterwards
+    int removed = 0;
+    IndexType prev = NULL_VALUE, ptr = head;
+    try {
+        while (ptr != NULL_VALUE) {
+            IndexType following = pool->next(ptr);
+            if (pred(pool->value(ptr))) {
+                if (prev == NULL_VALUE)
+                    head = following;
+                else
+                    pool->next(prev) = following;
+                if (ptr == tail)
+                    tail = prev;
+                pool->deleteNode(ptr);
+                --count;
+                ++churn;
+                ++removed;
+            } else {
+                prev = ptr;
+            }
+            ptr = following;
+        }
+    } catch (...) {
+        if (removed > 0) {
+            rebuildIndex();
+            rebuildLanes();
+        }
+        throw;
+    }
+    if (removed > 0) {
+        rebuildIndex();
+        rebuildLanes();
+    }
+    return removed;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const uint32_t List<T, NUM_NODES, Layout, IndexType, Stats>::SNAPSHOT_MAGIC;
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const uint32_t List<T, NUM_NODES, Layout, IndexType, Stats>::SNAPSHOT_VERSION;
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const int List<T, NUM_NODES, Layout, IndexType, Stats>::SNAPSHOT_BUFFER;
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const int List<T, NUM_NODES, Layout, IndexType, Stats>::FIND_BATCH;
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+uint64_t List<T, NUM_NODES, Layout, IndexType, Stats>::snapshotFingerprint() {
+    // FNV-1a over the type name and layout, as MappedNodePool does
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    auto mix = [&hash](uint64_t byte) { hash = (hash ^ byte) * 0x100000001B3ULL; };
+    for (const char* p = typeid(T).name(); *p; ++p)
+        mix(static_cast<unsigned char>(*p));
+    mix(sizeof(T));
+    mix(alignof(T));
+    return hash;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::saveBinary(ostream& out) const {
+    static_assert(is_trivially_copyable<T>::value || is_same<T, string>::value,
+                  "List::saveBinary supports trivially copyable types and std::string");
+    uint32_t header[3] = { SNAPSHOT_MAGIC, SNAPSHOT_VERSION,
+                           is_same<T, string>::value ? 0u : uint32_t(sizeof(T)) };
+    uint64_t fingerprint = snapshotFingerprint();
+    uint64_t n = count;
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    if constexpr (is_same<T, string>::value) {
+        for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr)) {
+            const string& s = pool->value(ptr);
+            uint64_t len = s.size();
+            out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+            out.write(s.data(), streamsize(len));
+        }
+    } else {
+        // Gather elements into a buffer so the stream sees few large writes
+        const int BATCH = SNAPSHOT_BUFFER / int(sizeof(T)) > 0 ? SNAPSHOT_BUFFER / int(sizeof(T)) : 1;
+        char buffer[BATCH * sizeof(T)];
+        int used = 0;
+        for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr)) {
+            memcpy(buffer + used * sizeof(T), &pool->value(ptr), sizeof(T));
+            if (++used == BATCH) {
+                out.write(buffer, streamsize(used * sizeof(T)));
+                used = 0;
+            }
+        }
+        out.write(buffer, streamsize(used * sizeof(T)));
+    }
+    if (!out)
+        throw runtime_error("List::saveBinary write failed");
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::loadBinary(istream& in) {
+    static_assert(is_trivially_copyable<T>::value || is_same<T, string>::value,
+                  "List::loadBinary supports trivially copyable types and std::string");
+    static_assert(is_default_constructible<T>::value,
+                  "List::loadBinary needs a default constructible T to copy records into");
+    uint32_t header[3];
+    uint64_t fingerprint, n;
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    in.read(reinterpret_cast<char*>(&fingerprint), sizeof(fingerprint));
+    in.read(reinterpret_cast<char*>(&n), sizeof(n));
+    if (!in || header[0] != SNAPSHOT_MAGIC || header[1] != SNAPSHOT_VERSION)
+        throw runtime_error("List::loadBinary not a list snapshot");
+    if (header[2] != (is_same<T, string>::value ? 0u : uint32_t(sizeof(T))) ||
+        fingerprint != snapshotFingerprint())
+        throw runtime_error("List::loadBinary snapshot holds another element type");
+
+    // Elements are appended one by one, so the index is rebuilt afterwards
+    unique_ptr<NodeIndex> savedIndex(std::move(nodeIndex));
+    unique_ptr<SkipLanes> savedLanes(std::move(sortedLanes));
+    try {
+        clear();
+        if constexpr (is_same<T, string>::value) {
+            for (; n > 0; --n) {
+                uint64_t len;
+                in.read(reinterpret_cast<char*>(&len), sizeof(len));
+                if (!in)
+                    throw runtime_error("List::loadBinary truncated snapshot");
+                // Grow the string as its bytes arrive, so a bad length
+                // fails at the end of the stream rather than in allocation
+                string s;
+                while (s.size() < len) {
+                    size_t old = s.size();
+                    size_t step = min<uint64_t>(len - old, SNAPSHOT_BUFFER);
+                    s.resize(old + step);
+                    in.read(&s[old], streamsize(step));
+                    if (!in)
+                        throw runtime_error("List::loadBinary truncated snapshot");
+                }
+                emplaceBack(std::move(s));
+            }
+        } else {
+            const int BATCH = SNAPSHOT_BUFFER / int(sizeof(T)) > 0 ? SNAPSHOT_BUFFER / int(sizeof(T)) : 1;
+            char buffer[BATCH * sizeof(T)];
+            while (n > 0) {
+                int batch = n < uint64_t(BATCH) ? int(n) : BATCH;
+                in.read(buffer, streamsize(batch * sizeof(T)));
+                if (!in)
+                    throw runtime_error("List::loadBinary truncated snapshot");
+                // The buffer holds bytes, not objects: copy each record into a T
+                for (int i = 0; i < batch; ++i) {
+                    T item;
+                    memcpy(&item, buffer + i * sizeof(T), sizeof(T));
+                    emplaceBack(item);
+                }
+                n -= batch;
+            }
+        }
+    } catch (...) {
+        nodeIndex = std::move(savedIndex);
+        sortedLanes = std::move(savedLanes);
+        rebuildIndex();
+        rebuildLanes();
+        throw;
+    }
+    nodeIndex = std::move(savedIndex);
+    sortedLanes = std::move(savedLanes);
+    rebuildIndex();
+    rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::printList() const {
     cout << "List contents: ";
-    traverse([](const T& s) {
+    for (const T& s : *this)
         cout << s << " ";
-    });
-    cout << "\nFree-list head index: " << pool.getFreeListHead() << "\n";
+    cout << "\nFree-list head index: " << +getFreeListHead() << "\n";
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::sortList() {
-    if (isEmpty())
-        throw underflow_error("List::sortList() on empty list");
-    if ( pool.data()[head].next == NULL_VALUE)
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::sortList() {
+    sortList(less<T>());
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename Compare>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::sortList(Compare comp) {
+    // The lanes index ascending order only; any other order leaves them wrong
+    if (!isAscending<Compare>())
+        sortedLanes.reset();
+    if (isEmpty() || pool->next(head) == NULL_VALUE)
         return;
+    sortChain(head, tail, count, comp);
+    rebuildIndex();
+    rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename Compare>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::sortChain(IndexType& first, IndexType& last, int length,
+                                                             Compare& comp) {
+    for (int width = 1; width < length; width *= 2) {
+        IndexType newHead = NULL_VALUE, newTail = NULL_VALUE;
+        IndexType rest = first;
+        while (rest != NULL_VALUE) {
+            IndexType left = rest;
+            IndexType right = splitRun(left, width);
+            rest = splitRun(right, width);
+
+            IndexType runFirst, runLast;
+            mergeRuns(left, right, comp, runFirst, runLast);
+            if (newHead == NULL_VALUE)
+                newHead = runFirst;
+            else
+                pool->next(newTail) = runFirst;
+            newTail = runLast;
+        }
+        first = newHead;
+        last = newTail;
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::splitRun(IndexType start, int n) {
+    if (start == NULL_VALUE)
+        return NULL_VALUE;
+    for (int i = 1; i < n && pool->next(start) != NULL_VALUE; ++i)
+        start = pool->next(start);
+    IndexType rest = pool->next(start);
+    pool->next(start) = NULL_VALUE;
+    return rest;
+}
 
-    for (int i = head; i != NULL_VALUE; i = pool.data()[i].next) {
-        for (int j = pool.data()[i].next; j != NULL_VALUE; j = pool.data()[j].next) {
-            if (pool.data()[j].data < pool.data()[i].data) {
-                T temp = pool.data()[i].data;
-                pool.data()[i].data = pool.data()[j].data;
-                pool.data()[j].data = temp;
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename Compare>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::mergeRuns(IndexType left, IndexType right, Compare& comp,
+                                   IndexType& first, IndexType& last) {
+    first = last = NULL_VALUE;
+    while (left != NULL_VALUE && right != NULL_VALUE) {
+        IndexType pick;
+        if (comp(pool->value(right), pool->value(left))) {
+            pick = right;
+            right = pool->next(right);
+        } else {
+            pick = left;
+            left = pool->next(left);
+        }
+        if (first == NULL_VALUE)
+            first = pick;
+        else
+            pool->next(last) = pick;
+        last = pick;
+    }
+    IndexType remaining = (left != NULL_VALUE) ? left : right;
+    if (first == NULL_VALUE)
+        first = last = remaining;
+    else
+        pool->next(last) = remaining;
+    while (pool->next(last) != NULL_VALUE)
+        last = pool->next(last);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::unique() {
+    if (isEmpty() || pool->next(head) == NULL_VALUE)
+        return;
+
+    if constexpr (IsHashable<T>::value)
+        uniqueByHash();
+    else if constexpr (IsOrdered<T>::value)
+        uniqueByOrder();
+    else
+        uniqueByScan();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::enableIndex() {
+    static_assert(IsHashable<T>::value, "List::enableIndex requires std::hash<T>");
+    if (!nodeIndex)
+        nodeIndex.reset(new NodeIndex());
+    rebuildIndex();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::disableIndex() {
+    nodeIndex.reset();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+bool List<T, NUM_NODES, Layout, IndexType, Stats>::isIndexed() const {
+    return nodeIndex != nullptr;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::indexLinked(IndexType idx, IndexType prev) {
+    if constexpr (IsHashable<T>::value) {
+        if (!nodeIndex)
+            return;
+        vector<IndexType>& before = nodeIndex->prev;
+        IndexType after = pool->next(idx);
+        size_t highest = static_cast<size_t>(idx);
+        if (after != NULL_VALUE && static_cast<size_t>(after) > highest)
+            highest = static_cast<size_t>(after);
+        if (before.size() <= highest)
+            before.resize(highest + 1, NULL_VALUE);
+        before[idx] = prev;
+        if (after != NULL_VALUE)
+            before[after] = idx;
+        nodeIndex->nodes.emplace(&pool->value(idx), idx);
+    } else {
+        (void)idx;
+        (void)prev;
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::indexUnlinking(IndexType idx, IndexType prev) {
+    if constexpr (IsHashable<T>::value) {
+        if (!nodeIndex)
+            return;
+        auto range = nodeIndex->nodes.equal_range(&pool->value(idx));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == idx) {
+                nodeIndex->nodes.erase(it);
+                break;
             }
         }
+        IndexType after = pool->next(idx);
+        if (after != NULL_VALUE)
+            nodeIndex->prev[after] = prev;
+    } else {
+        (void)idx;
+        (void)prev;
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::rebuildIndex() {
+    if constexpr (IsHashable<T>::value) {
+        if (!nodeIndex)
+            return;
+        nodeIndex->nodes.clear();
+        nodeIndex->nodes.reserve(count);
+        IndexType prev = NULL_VALUE;
+        for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr)) {
+            indexLinked(ptr, prev);
+            prev = ptr;
+        }
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::enableSortedIndex() {
+    static_assert(IsOrdered<T>::value, "List::enableSortedIndex requires operator<");
+    if (!sortedLanes) {
+        sortList();
+        sortedLanes.reset(new SkipLanes());
     }
+    rebuildLanes();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::disableSortedIndex() {
+    sortedLanes.reset();
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+bool List<T, NUM_NODES, Layout, IndexType, Stats>::hasSortedIndex() const {
+    return sortedLanes != nullptr;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::lowerBound(const T& item) const {
+    IndexType prev = orderedSearch(item, false, nullptr);
+    return (prev == NULL_VALUE) ? head : pool->next(prev);
 }
 
-template<typename T, int NUM_NODES>
-void List<T, NUM_NODES>::unique() {
-    if (isEmpty() || pool.data()[head].next == NULL_VALUE)
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::upperBound(const T& item) const {
+    IndexType prev = orderedSearch(item, true, nullptr);
+    return (prev == NULL_VALUE) ? head : pool->next(prev);
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename F>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::forEachInRange(const T& low, const T& high, F&& visit) const {
+    for (IndexType ptr = lowerBound(low); ptr != NULL_VALUE && pool->value(ptr) < high;
+         ptr = pool->next(ptr))
+        visit(pool->value(ptr));
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::laneDescend(const T& item, bool inclusive,
+                                                                    IndexType* update, long long* hops) const {
+    const SkipLanes& lanes = *sortedLanes;
+    auto before = [&](IndexType entry) {
+        const T& element = pool->value(lanes.entries.value(entry).node);
+        return inclusive ? !(item < element) : element < item;
+    };
+    IndexType entry = NULL_VALUE;
+    long long links = 0;
+    for (int level = MAX_LANES - 1; level >= 0; --level) {
+        IndexType ahead = (entry == NULL_VALUE) ? lanes.heads[level] : lanes.entries.next(entry);
+        while (ahead != NULL_VALUE && before(ahead)) {
+            entry = ahead;
+            ahead = lanes.entries.next(entry);
+            ++links;
+        }
+        if (update)
+            update[level] = entry;
+        if (level > 0 && entry != NULL_VALUE)
+            entry = lanes.entries.value(entry).down;
+    }
+    if (hops)
+        *hops += links;
+    return entry;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType List<T, NUM_NODES, Layout, IndexType, Stats>::orderedSearch(const T& item, bool inclusive,
+                                                                      IndexType* update, long long* hops) const {
+    static_assert(IsOrdered<T>::value, "List ordered search requires operator<");
+    IndexType prev = NULL_VALUE;
+    if (sortedLanes) {
+        IndexType entry = laneDescend(item, inclusive, update, hops);
+        if (entry != NULL_VALUE)
+            prev = sortedLanes->entries.value(entry).node;
+    }
+    // Finish on the next chain from the closest node the lanes reached
+    IndexType curr = (prev == NULL_VALUE) ? head : pool->next(prev);
+    long long links = 0;
+    while (curr != NULL_VALUE &&
+           (inclusive ? !(item < pool->value(curr)) : pool->value(curr) < item)) {
+        prev = curr;
+        curr = pool->next(curr);
+        ++links;
+    }
+    if (hops)
+        *hops += links;
+    return prev;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::laneLinked(IndexType idx, const IndexType* update) {
+    SkipLanes& lanes = *sortedLanes;
+    int h = lanes.randomHeight();
+    if (h == 0)
         return;
+    if (lanes.height.size() <= static_cast<size_t>(idx))
+        lanes.height.resize(static_cast<size_t>(idx) + 1, 0);
+    lanes.height[idx] = static_cast<unsigned char>(h);
+    IndexType below = NULL_VALUE;
+    for (int level = 0; level < h; ++level) {
+        IndexType entry = lanes.entries.newNode(LaneEntry{idx, below});
+        IndexType prev = update[level];
+        if (prev == NULL_VALUE) {
+            lanes.entries.next(entry) = lanes.heads[level];
+            lanes.heads[level] = entry;
+        } else {
+            lanes.entries.next(entry) = lanes.entries.next(prev);
+            lanes.entries.next(prev) = entry;
+        }
+        below = entry;
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::laneUnlinking(IndexType idx) {
+    if constexpr (IsOrdered<T>::value) {
+        if (!sortedLanes)
+            return;
+        SkipLanes& lanes = *sortedLanes;
+        if (lanes.height.size() <= static_cast<size_t>(idx) || lanes.height[idx] == 0)
+            return;
+        int h = lanes.height[idx];
+        lanes.height[idx] = 0;
+
+        const T& item = pool->value(idx);
+        IndexType update[MAX_LANES];
+        laneDescend(item, false, update);
+        for (int level = 0; level < h; ++level) {
+            // idx sits among the entries equal to item that follow update
+            IndexType prev = update[level];
+            IndexType entry = (prev == NULL_VALUE) ? lanes.heads[level] : lanes.entries.next(prev);
+            while (entry != NULL_VALUE && lanes.entries.value(entry).node != idx &&
+                   !(item < pool->value(lanes.entries.value(entry).node))) {
+                prev = entry;
+                entry = lanes.entries.next(entry);
+            }
+            if (entry == NULL_VALUE || lanes.entries.value(entry).node != idx) {
+                // The list was left out of order; fall back to a full scan
+                prev = NULL_VALUE;
+                entry = lanes.heads[level];
+                while (entry != NULL_VALUE && lanes.entries.value(entry).node != idx) {
+                    prev = entry;
+                    entry = lanes.entries.next(entry);
+                }
+                if (entry == NULL_VALUE)
+                    continue;
+            }
+            if (prev == NULL_VALUE)
+                lanes.heads[level] = lanes.entries.next(entry);
+            else
+                lanes.entries.next(prev) = lanes.entries.next(entry);
+            lanes.entries.deleteNode(entry);
+        }
+    } else {
+        (void)idx;
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::rebuildLanes() {
+    if (!sortedLanes)
+        return;
+    SkipLanes& lanes = *sortedLanes;
+    lanes.entries.initializePool();
+    lanes.height.clear();
+    IndexType last[MAX_LANES];
+    for (int level = 0; level < MAX_LANES; ++level)
+        lanes.heads[level] = last[level] = NULL_VALUE;
+
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr)) {
+        int h = lanes.randomHeight();
+        if (h == 0)
+            continue;
+        if (lanes.height.size() <= static_cast<size_t>(ptr))
+            lanes.height.resize(static_cast<size_t>(ptr) + 1, 0);
+        lanes.height[ptr] = static_cast<unsigned char>(h);
+        IndexType below = NULL_VALUE;
+        for (int level = 0; level < h; ++level) {
+            IndexType entry = lanes.entries.newNode(LaneEntry{ptr, below});
+            if (last[level] == NULL_VALUE)
+                lanes.heads[level] = entry;
+            else
+                lanes.entries.next(last[level]) = entry;
+            last[level] = entry;
+            below = entry;
+        }
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+int List<T, NUM_NODES, Layout, IndexType, Stats>::uniqueAdjacent() {
+    if (isEmpty())
+        return 0;
+
+    int removed = 0;
+    IndexType prev = head;
+    while (pool->next(prev) != NULL_VALUE) {
+        if (pool->value(pool->next(prev)) == pool->value(prev)) {
+            deleteAfter(prev);
+            ++removed;
+        } else {
+            prev = pool->next(prev);
+        }
+    }
+    return removed;
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::uniqueByHash() {
+    // The set refers to elements in place; nodes never move while linked
+    unordered_set<const T*, IndexHash, IndexEqual> seen;
+    seen.reserve(count);
+
+    seen.insert(&pool->value(head));
+    IndexType prev = head;
+    while (pool->next(prev) != NULL_VALUE) {
+        IndexType curr = pool->next(prev);
+        if (seen.insert(&pool->value(curr)).second)
+            prev = curr;
+        else
+            deleteAfter(prev);
+    }
+}
+
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::uniqueByOrder() {
+    // Pair each node with its list position, then sort stably by value so
+    // the first occurrence leads each run of equal elements
+    vector<pair<IndexType, int>> order;
+    order.reserve(count);
+    int position = 0;
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool->next(ptr))
+        order.push_back(make_pair(ptr, position++));
+    stable_sort(order.begin(), order.end(),
+                [this](const pair<IndexType, int>& a, const pair<IndexType, int>& b) {
+                    return pool->value(a.first) < pool->value(b.first);
+                });
+
+    vector<bool> duplicate(count, false);
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (pool->value(order[i].first) == pool->value(order[i - 1].first))
+            duplicate[order[i].second] = true;
+    }
+
+    IndexType prev = head;
+    position = 1;
+    while (pool->next(prev) != NULL_VALUE) {
+        if (duplicate[position++])
+            deleteAfter(prev);
+        else
+            prev = pool->next(prev);
+    }
+}
 
-    int outer = head;
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void List<T, NUM_NODES, Layout, IndexType, Stats>::uniqueByScan() {
+    IndexType outer = head;
     while (outer != NULL_VALUE) {
-        int prev = outer;
-        int curr = pool.data()[outer].next;
+        IndexType prev = outer;
+        IndexType curr = pool->next(outer);
         while (curr != NULL_VALUE) {
-            if (pool.data()[curr].data == pool.data()[outer].data) {
-                pool.data()[prev].next = pool.data()[curr].next;
-                pool.deleteNode(curr);
-                curr = pool.data()[prev].next;
+            if (pool->value(curr) == pool->value(outer)) {
+                deleteAfter(prev);
+                curr = pool->next(prev);
             } else {
                 prev = curr;
-                curr = pool.data()[curr].next;
+                curr = pool->next(curr);
             }
         }
-        outer = pool.data()[outer].next;
+        outer = pool->next(outer);
     }
 }
 
 
-template<typename T, int NUM_NODES>
-ostream& operator<<(ostream& os, const List<T, NUM_NODES>& lst) {
-    lst.traverse([&os](const T& s) {
+template<typename T, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+ostream& operator<<(ostream& os, const List<T, NUM_NODES, Layout, IndexType, Stats>& lst) {
+    for (const T& s : lst)
         os << s << " ";
-    });
-    os << "\nFree-list head index: " << lst.getFreeListHead() << "\n";
+    os << "\nFree-list head index: " << +lst.getFreeListHead() << "\n";
     return os;
 }
 #endif // LIST_H
\ No newline at end of file
@@ -0,0 +1,35 @@
+/*-- ListTraits.h ----------------------------------------------------------
+
+  This header file defines the element traits the list classes use to
+  decide at compile time which optional features an element type allows:
+     IsHashable:         std::hash<T> is enabled, so a hash index can be built.
+     IsOrdered:          T supports operator<, so ordered searches and
+                         sorting are available.
+-------------------------------------------------------------------------*/
+
+#ifndef LISTTRAITS_H
+#define LISTTRAITS_H
+
+#include <functional>   // For std::hash
+#include <type_traits>
+#include <utility>      // For std::declval
+
+using namespace std;
+
+// IsHashable is true when std::hash<T> is enabled for T
+template<typename T, typename = void>
+struct IsHashable : false_type {};
+
+template<typename T>
+struct IsHashable<T, typename enable_if<is_default_constructible<hash<T>>::value>::type>
+    : true_type {};
+
+// IsOrdered is true when T supports operator<
+template<typename T, typename = void>
+struct IsOrdered : false_type {};
+
+template<typename T>
+struct IsOrdered<T, decltype(void(declval<const T&>() < declval<const T&>()))>
+    : true_type {};
+
+#endif // LISTTRAITS_H
@@ -0,0 +1,397 @@
+/*-- LruCache.h -----------------------------------------------------------
+
+This header file defines the LruCache class, a fixed-capacity key-value
+cache that evicts the least recently used entry. Entries live in a
+NodePool sized for CAPACITY and form a doubly linked recency list: the
+pool's next link points toward the least recent end and each entry keeps
+its previous index. Keys are found through an open-addressing hash table
+of node indices with linear probing. When the cache is full, a new key
+takes over the slot of the evicted entry in place, so once constructed
+the cache never allocates.
+Every operation runs in O(1) on average.
+  Basic operations are:
+     Constructor:        Initializes an empty cache and all its storage.
+     isEmpty:            Checks if the cache is empty.
+     size:               Returns the number of entries.
+     capacity:           Returns the largest number of entries.
+     contains:           Checks if a key is cached, without touching it.
+     get:                Looks up a key and marks it most recently used.
+     put:                Inserts or updates a key, evicting if full.
+     touch:              Marks a key most recently used.
+     erase:              Removes a key.
+     clear:              Removes every entry.
+     forEach:            Applies a callable to each entry, most recent first.
+-------------------------------------------------------------------------*/
+
+#ifndef LRUCACHE_H
+#define LRUCACHE_H
+
+#include "NodePool.h"
+#include <functional>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+using namespace std;
+
+template<typename K, typename V, int CAPACITY, typename Hash = hash<K>,
+         typename IndexType = typename SmallestIndex<CAPACITY>::type>
+class LruCache {
+    static_assert(CAPACITY > 0, "LruCache needs room for at least one entry");
+
+public:
+    // Entry is the pool element: a key, its value and the link toward the
+    // more recent end (the pool's next link points the other way)
+    struct Entry {
+        K key;
+        V value;
+        IndexType prev;
+
+        template<typename KeyArg, typename ValueArg>
+        Entry(KeyArg&& key, ValueArg&& value)
+            : key(std::forward<KeyArg>(key)), value(std::forward<ValueArg>(value)), prev(NULL_VALUE) {}
+    };
+
+    typedef NodePool<Entry, CAPACITY, InterleavedLayout, IndexType> PoolType;
+    static const IndexType NULL_VALUE = PoolType::NULL_VALUE;
+
+    /***** Function Members ******/
+
+    /***** Constructor *****/
+    LruCache();
+    /*----------------------------------------------------------------------
+      Constructor for the LruCache class.
+      Precondition:  None
+      Postcondition: An empty cache whose node storage and hash table are
+                     allocated up front for CAPACITY entries.
+    ----------------------------------------------------------------------*/
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    /***** isEmpty *****/
+    bool isEmpty() const;
+    /*----------------------------------------------------------------------
+      Checks if the cache is empty.
+      Precondition:  None
+      Postcondition: Returns true if the cache holds no entry.
+    ----------------------------------------------------------------------*/
+
+    /***** size *****/
+    int size() const;
+    /*----------------------------------------------------------------------
+      Returns the number of entries in the cache.
+      Precondition:  None
+      Postcondition: Returns a count between 0 and CAPACITY.
+    ----------------------------------------------------------------------*/
+
+    /***** capacity *****/
+    int capacity() const;
+    /*----------------------------------------------------------------------
+      Returns the largest number of entries the cache holds.
+      Precondition:  None
+      Postcondition: Returns CAPACITY.
+    ----------------------------------------------------------------------*/
+
+    /***** contains *****/
+    bool contains(const K& key) const;
+    /*----------------------------------------------------------------------
+      Checks if a key is cached.
+      Precondition:  None
+      Postcondition: Returns true if key has an entry. Recency is unchanged.
+    ----------------------------------------------------------------------*/
+
+    /***** get *****/
+    V* get(const K& key);
+    /*----------------------------------------------------------------------
+      Looks up a key and marks its entry most recently used.
+      Precondition:  None
+      Postcondition: Returns a pointer to the cached value, or nullptr if
+                     key has no entry. The pointer stays valid until the
+                     entry is evicted or erased.
+    ----------------------------------------------------------------------*/
+
+    /***** put *****/
+    void put(const K& key, const V& value);
+    /*----------------------------------------------------------------------
+      Inserts or updates the entry for a key.
+      Precondition:  None
+      Postcondition: key maps to value and is the most recently used
+                     entry. If key was new and the cache was full, the
+                     least recently used entry has been evicted and its
+                     node reused for key.
+      Throws:        Whatever copying key or value throws. The cache is
+                     then unchanged, except that a move which throws after
+                     an eviction leaves the victim evicted.
+    ----------------------------------------------------------------------*/
+
+    /***** touch *****/
+    bool touch(const K& key);
+    /*----------------------------------------------------------------------
+      Marks the entry for a key most recently used.
+      Precondition:  None
+      Postcondition: Returns true if key has an entry, false otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** erase *****/
+    bool erase(const K& key);
+    /*----------------------------------------------------------------------
+      Removes the entry for a key.
+      Precondition:  None
+      Postcondition: Returns true if an entry was removed, false otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** clear *****/
+    void clear();
+    /*----------------------------------------------------------------------
+      Removes every entry.
+      Precondition:  None
+      Postcondition: The cache is empty; its storage is kept.
+    ----------------------------------------------------------------------*/
+
+    /***** forEach *****/
+    template<typename F>
+    void forEach(F&& visit) const;
+    /*----------------------------------------------------------------------
+      Applies a callable to each entry.
+      Precondition:  visit can be called with (const K&, const V&).
+      Postcondition: visit has been applied from the most to the least
+                     recently used entry. Recency is unchanged.
+    ----------------------------------------------------------------------*/
+
+private:
+    /***** findSlot *****/
+    int findSlot(const K& key) const;
+    /*----------------------------------------------------------------------
+      Probes the hash table for a key.
+      Precondition:  None
+      Postcondition: Returns the table position holding key's node, or -1.
+    ----------------------------------------------------------------------*/
+
+    /***** insertSlot *****/
+    void insertSlot(IndexType idx);
+    /*----------------------------------------------------------------------
+      Adds a node to the hash table under its key.
+      Precondition:  The node's key is not in the table.
+      Postcondition: The first empty position from the key's home holds idx.
+    ----------------------------------------------------------------------*/
+
+    /***** eraseSlot *****/
+    void eraseSlot(int pos);
+    /*----------------------------------------------------------------------
+      Removes a table position, shifting later entries of its probe run
+      back so no tombstone is needed.
+      Precondition:  pos holds a node.
+      Postcondition: Every remaining key is still found by findSlot.
+    ----------------------------------------------------------------------*/
+
+    /***** unlink / linkFront *****/
+    void unlink(IndexType idx);
+    void linkFront(IndexType idx);
+    /*----------------------------------------------------------------------
+      Take a node out of the recency list, or put it at the most recent end.
+    ----------------------------------------------------------------------*/
+
+    // The table has at least twice as many positions as entries, so probe
+    // runs stay short
+    static const int TABLE_SIZE = [] {
+        int n = 1;
+        while (n < 2 * CAPACITY) n <<= 1;
+        return n;
+    }();
+
+    size_t home(const K& key) const { return hasher(key) & (TABLE_SIZE - 1); }
+
+    PoolType pool;              // Entry storage, exactly CAPACITY nodes
+    vector<IndexType> table;    // Node index by hashed key (NULL_VALUE: empty)
+    IndexType head;             // Most recently used entry
+    IndexType tail;             // Least recently used entry
+    int count;                  // Number of entries
+    Hash hasher;                // Hash function for keys
+};
+
+// Implementation
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+const IndexType LruCache<K, V, CAPACITY, Hash, IndexType>::NULL_VALUE;
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+const int LruCache<K, V, CAPACITY, Hash, IndexType>::TABLE_SIZE;
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+LruCache<K, V, CAPACITY, Hash, IndexType>::LruCache()
+    : pool(CAPACITY), table(TABLE_SIZE, NULL_VALUE), head(NULL_VALUE), tail(NULL_VALUE), count(0), hasher() {
+    pool.reserve(CAPACITY);
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+bool LruCache<K, V, CAPACITY, Hash, IndexType>::isEmpty() const {
+    return count == 0;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+int LruCache<K, V, CAPACITY, Hash, IndexType>::size() const {
+    return count;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+int LruCache<K, V, CAPACITY, Hash, IndexType>::capacity() const {
+    return CAPACITY;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+bool LruCache<K, V, CAPACITY, Hash, IndexType>::contains(const K& key) const {
+    return findSlot(key) >= 0;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+V* LruCache<K, V, CAPACITY, Hash, IndexType>::get(const K& key) {
+    int pos = findSlot(key);
+    if (pos < 0)
+        return nullptr;
+    IndexType idx = table[pos];
+    if (idx != head) {
+        unlink(idx);
+        linkFront(idx);
+    }
+    return &pool.value(idx).value;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+void LruCache<K, V, CAPACITY, Hash, IndexType>::put(const K& key, const V& value) {
+    int pos = findSlot(key);
+    if (pos >= 0) {
+        IndexType idx = table[pos];
+        pool.value(idx).value = value;
+        if (idx != head) {
+            unlink(idx);
+            linkFront(idx);
+        }
+        return;
+    }
+    IndexType idx;
+    if (count == CAPACITY) {
+        // Evict the least recent entry and reuse its node in place. Copy
+        // first, so a throwing copy leaves the cache untouched
+        K newKey(key);
+        V newValue(value);
+        idx = tail;
+        Entry& victim = pool.value(idx);
+        eraseSlot(findSlot(victim.key));
+        unlink(idx);
+        --count;
+        try {
+            victim.key = std::move(newKey);
+            victim.value = std::move(newValue);
+        } catch (...) {
+            pool.deleteNode(idx);   // The victim is already evicted
+            throw;
+        }
+    } else {
+        idx = pool.newNode(key, value);
+    }
+    linkFront(idx);
+    insertSlot(idx);
+    ++count;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+bool LruCache<K, V, CAPACITY, Hash, IndexType>::touch(const K& key) {
+    return get(key) != nullptr;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+bool LruCache<K, V, CAPACITY, Hash, IndexType>::erase(const K& key) {
+    int pos = findSlot(key);
+    if (pos < 0)
+        return false;
+    IndexType idx = table[pos];
+    eraseSlot(pos);
+    unlink(idx);
+    pool.deleteNode(idx);
+    --count;
+    return true;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+void LruCache<K, V, CAPACITY, Hash, IndexType>::clear() {
+    while (head != NULL_VALUE) {
+        IndexType following = pool.next(head);
+        pool.deleteNode(head);
+        head = following;
+    }
+    tail = NULL_VALUE;
+    count = 0;
+    fill(table.begin(), table.end(), NULL_VALUE);
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+template<typename F>
+void LruCache<K, V, CAPACITY, Hash, IndexType>::forEach(F&& visit) const {
+    for (IndexType ptr = head; ptr != NULL_VALUE; ptr = pool.next(ptr)) {
+        const Entry& e = pool.value(ptr);
+        visit(e.key, e.value);
+    }
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+int LruCache<K, V, CAPACITY, Hash, IndexType>::findSlot(const K& key) const {
+    for (size_t pos = home(key);; pos = (pos + 1) & (TABLE_SIZE - 1)) {
+        IndexType idx = table[pos];
+        if (idx == NULL_VALUE)
+            return -1;
+        if (pool.value(idx).key == key)
+            return static_cast<int>(pos);
+    }
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+void LruCache<K, V, CAPACITY, Hash, IndexType>::insertSlot(IndexType idx) {
+    size_t pos = home(pool.value(idx).key);
+    while (table[pos] != NULL_VALUE)
+        pos = (pos + 1) & (TABLE_SIZE - 1);
+    table[pos] = idx;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+void LruCache<K, V, CAPACITY, Hash, IndexType>::eraseSlot(int pos) {
+    const size_t mask = TABLE_SIZE - 1;
+    size_t hole = static_cast<size_t>(pos);
+    for (size_t i = (hole + 1) & mask; table[i] != NULL_VALUE; i = (i + 1) & mask) {
+        // Move the entry back unless its home lies cyclically in (hole, i]
+        size_t h = home(pool.value(table[i]).key);
+        if (((i - h) & mask) >= ((i - hole) & mask)) {
+            table[hole] = table[i];
+            hole = i;
+        }
+    }
+    table[hole] = NULL_VALUE;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+void LruCache<K, V, CAPACITY, Hash, IndexType>::unlink(IndexType idx) {
+    IndexType before = pool.value(idx).prev;
+    IndexType after = pool.next(idx);
+    if (before == NULL_VALUE)
+        head = after;
+    else
+        pool.next(before) = after;
+    if (after == NULL_VALUE)
+        tail = before;
+    else
+        pool.value(after).prev = before;
+}
+
+template<typename K, typename V, int CAPACITY, typename Hash, typename IndexType>
+void LruCache<K, V, CAPACITY, Hash, IndexType>::linkFront(IndexType idx) {
+    pool.value(idx).prev = NULL_VALUE;
+    pool.next(idx) = head;
+    if (head == NULL_VALUE)
+        tail = idx;
+    else
+        pool.value(head).prev = idx;
+    head = idx;
+}
+
+#endif // LRUCACHE_H
@@ -0,0 +1,480 @@
+/*-- MappedNodePool.h ------------------------------------------------------
+
+  This header file defines the MappedNodePool class, a node pool that lives
+  in a memory-mapped file. Links are indices rather than pointers, so the
+  pool image does not depend on the address it is mapped at: a process can
+  map yesterday's file and use its nodes straight away, in O(1).
+  The file starts with a fixed header followed by the node array:
+     magic, version:     Identify the file format.
+     nodeSize,
+     fingerprint:        Identify the element and index types; a file
+                         written for other types is refused.
+     capacity:           Number of nodes in the node array.
+     highWater,
+     freeListHead:       Allocation state, as in NodePool.
+     root:               head, tail and count of the structure built on the
+                         pool, so it can find its nodes again.
+  Each node also carries a live flag, so a freed position is told apart
+  from an allocated one even after the file is reopened.
+  Only trivially copyable elements can be stored, since their bytes are
+  their value. Changes reach the file through the shared mapping; sync
+  forces them to disk. The file is not crash-consistent between syncs.
+  Basic operations are:
+     Constructor:        Opens a pool file, or creates it if it is empty.
+     Destructor:         Unmaps the file.
+     newNode:            Allocates a new node from the pool.
+     deleteNode:         Recycles a node back into the free list.
+     value:              Accessor to the data stored in a node.
+     next:               Accessor to the link stored in a node.
+     root:               Accessor to the root fields in the file header.
+     getFreeListHead:    Retrieves the index of the next node to be allocated.
+     capacity:           Returns the number of nodes the pool can hold.
+     isGrowable:         Checks if the file grows when it runs out of nodes.
+     isValidIndex:       Checks if an index lies in the used part of the pool.
+     isLive:             Checks if a node is allocated.
+     reserve:            Extends the file to hold at least a given number of nodes.
+     sync:               Writes the mapped pages back to the file.
+-------------------------------------------------------------------------*/
+
+#ifndef MAPPEDNODEPOOL_H
+#define MAPPEDNODEPOOL_H
+
+#include "NodePool.h"
+#include <string>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <typeinfo>
+#include <new>
+#include <utility>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+template<typename ElementType, int NUM_NODES = 2048,
+         typename IndexType = typename SmallestIndex<NUM_NODES>::type>
+class MappedNodePool {
+    static_assert(is_trivially_copyable<ElementType>::value,
+                  "MappedNodePool stores elements as raw bytes; ElementType must be trivially copyable");
+
+public:
+    typedef IndexType Index;
+    static const IndexType NULL_VALUE = static_cast<IndexType>(~IndexType(0));  // Sentinel value indicating end of list
+    static const int MAX_CAPACITY =    // Largest number of nodes the index type can address
+        numeric_limits<IndexType>::max() < numeric_limits<int>::max()
+            ? static_cast<int>(numeric_limits<IndexType>::max())
+            : numeric_limits<int>::max();
+    static const uint64_t MAGIC = 0x4C4F4F5045444F4EULL;  // "NODEPOOL"
+    static const uint32_t VERSION = 2;
+
+    // Root fields the owner of the pool keeps in the file header
+    struct Root {
+        uint64_t head;
+        uint64_t tail;
+        uint64_t count;
+    };
+
+    /***** Function Members ******/
+
+    /***** Constructor *****/
+    explicit MappedNodePool(const string& path, int initialCapacity = NUM_NODES, bool growable = false);
+    /*----------------------------------------------------------------------
+      Maps the pool file at path, creating it if it does not exist or is
+      empty.
+      Precondition:  0 < initialCapacity <= MAX_CAPACITY.
+      Postcondition: An existing file keeps its nodes, free list, capacity
+                     and root; initialCapacity is then ignored. A new file
+                     holds initialCapacity free nodes, and its root has
+                     NULL_VALUE head and tail and a count of 0. A growable
+                     pool extends the file on demand, up to MAX_CAPACITY
+                     nodes, instead of overflowing.
+      Throws:        invalid_argument if initialCapacity is out of range,
+                     runtime_error if the file was written for other types
+                     or is damaged, system_error if a system call fails.
+    ----------------------------------------------------------------------*/
+
+    MappedNodePool(const MappedNodePool&) = delete;
+    MappedNodePool& operator=(const MappedNodePool&) = delete;
+
+    /***** Destructor *****/
+    ~MappedNodePool();
+    /*----------------------------------------------------------------------
+      Unmaps and closes the file.
+      Precondition:  None
+      Postcondition: The nodes remain in the file. Call sync first if they
+                     must be on disk rather than in the page cache.
+    ----------------------------------------------------------------------*/
+
+    /***** newNode *****/
+    template<typename... Args>
+    IndexType newNode(Args&&... args);
+    /*----------------------------------------------------------------------
+      Allocates a new node and constructs its data in place from args.
+      Precondition:  There must be a free node, or the pool must be growable.
+      Postcondition: Returns the index of the newly allocated node. Growing
+                     remaps the file, so references into the pool held
+                     across this call may dangle; indices stay valid.
+      Throws:        overflow_error if the pool is out of free nodes.
+    ----------------------------------------------------------------------*/
+
+    /***** deleteNode *****/
+    void deleteNode(IndexType idx);
+    /*----------------------------------------------------------------------
+      Recycles a node back into the free list.
+      Precondition:  idx names an allocated node.
+      Postcondition: The node heads the free list.
+      Throws:        out_of_range if idx is not an allocated node.
+    ----------------------------------------------------------------------*/
+
+    /***** value *****/
+    ElementType& value(IndexType idx);
+    const ElementType& value(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Provides access to the data stored in a node.
+      Precondition:  idx names an allocated node.
+      Postcondition: Returns a reference to the node's data.
+    ----------------------------------------------------------------------*/
+
+    /***** next *****/
+    IndexType& next(IndexType idx);
+    IndexType next(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Provides access to the link stored in a node.
+      Precondition:  0 <= idx < capacity().
+      Postcondition: Returns the node's next index.
+    ----------------------------------------------------------------------*/
+
+    /***** root *****/
+    Root& root();
+    const Root& root() const;
+    /*----------------------------------------------------------------------
+      Provides access to the root fields stored in the file header.
+      Precondition:  None
+      Postcondition: Returns the root, which persists with the nodes.
+    ----------------------------------------------------------------------*/
+
+    /***** getFreeListHead *****/
+    IndexType getFreeListHead() const;
+    /*----------------------------------------------------------------------
+      Retrieves the index of the node the next newNode call will return.
+      Precondition:  None
+      Postcondition: Returns the first recycled node if there is one,
+                     otherwise the high-water index, or NULL_VALUE if the
+                     pool is full.
+    ----------------------------------------------------------------------*/
+
+    /***** capacity *****/
+    int capacity() const;
+    /*----------------------------------------------------------------------
+      Returns the number of nodes the file currently holds.
+    ----------------------------------------------------------------------*/
+
+    /***** isGrowable *****/
+    bool isGrowable() const;
+    /*----------------------------------------------------------------------
+      Checks if the file is extended when the pool runs out of free nodes.
+    ----------------------------------------------------------------------*/
+
+    /***** isValidIndex *****/
+    bool isValidIndex(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Checks if an index lies below the high-water index.
+      Precondition:  None
+      Postcondition: Returns true if idx has been handed out at some point.
+    ----------------------------------------------------------------------*/
+
+    /***** isLive *****/
+    bool isLive(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Checks if a node is allocated.
+      Precondition:  None
+      Postcondition: Returns true if idx was handed out by newNode and has
+                     not been recycled since. O(1).
+    ----------------------------------------------------------------------*/
+
+    /***** reserve *****/
+    void reserve(int newCapacity);
+    /*----------------------------------------------------------------------
+      Extends the file so the pool holds at least newCapacity nodes.
+      Precondition:  newCapacity <= MAX_CAPACITY.
+      Postcondition: capacity() >= newCapacity. Existing nodes keep their
+                     indices; references into the pool may dangle.
+      Throws:        invalid_argument if newCapacity is too large,
+                     system_error if the file cannot be extended.
+    ----------------------------------------------------------------------*/
+
+    /***** sync *****/
+    void sync();
+    /*----------------------------------------------------------------------
+      Writes the mapped pages back to the file and waits for the write.
+      Precondition:  None
+      Postcondition: The file on disk matches the pool.
+      Throws:        system_error if the write fails.
+    ----------------------------------------------------------------------*/
+
+private:
+    // NodeType is one entry of the node array in the file
+    struct NodeType {
+        alignas(ElementType) unsigned char data[sizeof(ElementType)];  // Raw storage for the data
+        IndexType next;    // Index of the next node
+        unsigned char live;  // 1 while allocated; new file space reads as 0
+    };
+
+    // FileHeader is the layout of the start of the file
+    struct FileHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t nodeSize;
+        uint64_t fingerprint;
+        uint64_t capacity;
+        uint64_t highWater;
+        uint64_t freeListHead;
+        Root root;
+    };
+
+    static const size_t DATA_OFFSET = 128;  // Start of the node array in the file
+    static_assert(sizeof(FileHeader) <= DATA_OFFSET && alignof(NodeType) <= DATA_OFFSET,
+                  "MappedNodePool header does not fit before the node array");
+
+    static uint64_t fingerprint();
+    static size_t fileSize(int nodes) { return DATA_OFFSET + size_t(nodes) * sizeof(NodeType); }
+    void map(int nodes);
+    FileHeader& header() { return *reinterpret_cast<FileHeader*>(base); }
+    const FileHeader& header() const { return *reinterpret_cast<const FileHeader*>(base); }
+    NodeType* nodes() { return reinterpret_cast<NodeType*>(base + DATA_OFFSET); }
+    const NodeType* nodes() const { return reinterpret_cast<const NodeType*>(base + DATA_OFFSET); }
+
+    int fd;                 // Descriptor of the pool file
+    unsigned char* base;    // Start of the mapping
+    size_t mappedSize;      // Length of the mapping in bytes
+    bool growable;          // Extend the file instead of overflowing
+};
+
+// Implementation
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const IndexType MappedNodePool<ElementType, NUM_NODES, IndexType>::NULL_VALUE;
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const int MappedNodePool<ElementType, NUM_NODES, IndexType>::MAX_CAPACITY;
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const uint64_t MappedNodePool<ElementType, NUM_NODES, IndexType>::MAGIC;
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const uint32_t MappedNodePool<ElementType, NUM_NODES, IndexType>::VERSION;
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const size_t MappedNodePool<ElementType, NUM_NODES, IndexType>::DATA_OFFSET;
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+MappedNodePool<ElementType, NUM_NODES, IndexType>::MappedNodePool(const string& path, int initialCapacity,
+                                                                  bool growable)
+    : fd(-1), base(nullptr), mappedSize(0), growable(growable) {
+    if (initialCapacity <= 0 || initialCapacity > MAX_CAPACITY)
+        throw invalid_argument("MappedNodePool: initial capacity out of range");
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        throw system_error(errno, generic_category(), "MappedNodePool: cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw system_error(err, generic_category(), "MappedNodePool: cannot stat " + path);
+    }
+    try {
+        if (st.st_size == 0) {
+            map(initialCapacity);
+            FileHeader& h = header();
+            h.magic = MAGIC;
+            h.version = VERSION;
+            h.nodeSize = sizeof(NodeType);
+            h.fingerprint = fingerprint();
+            h.capacity = initialCapacity;
+            h.highWater = 0;
+            h.freeListHead = NULL_VALUE;
+            h.root.head = h.root.tail = NULL_VALUE;
+            h.root.count = 0;
+        } else {
+            if (size_t(st.st_size) < DATA_OFFSET)
+                throw runtime_error("MappedNodePool: " + path + " is not a pool file");
+            const FileHeader* h = static_cast<const FileHeader*>(
+                ::mmap(nullptr, sizeof(FileHeader), PROT_READ, MAP_SHARED, fd, 0));
+            if (h == MAP_FAILED)
+                throw system_error(errno, generic_category(), "MappedNodePool: cannot map " + path);
+            FileHeader saved = *h;
+            ::munmap(const_cast<FileHeader*>(h), sizeof(FileHeader));
+            if (saved.magic != MAGIC || saved.version != VERSION)
+                throw runtime_error("MappedNodePool: " + path + " is not a pool file");
+            if (saved.nodeSize != sizeof(NodeType) || saved.fingerprint != fingerprint())
+                throw runtime_error("MappedNodePool: " + path + " was written for another element type");
+            if (saved.capacity == 0 || saved.capacity > uint64_t(MAX_CAPACITY)
+                || size_t(st.st_size) < fileSize(int(saved.capacity)) || saved.highWater > saved.capacity)
+                throw runtime_error("MappedNodePool: " + path + " is truncated or damaged");
+            map(int(saved.capacity));
+        }
+    } catch (...) {
+        if (base)
+            ::munmap(base, mappedSize);
+        ::close(fd);
+        throw;
+    }
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+MappedNodePool<ElementType, NUM_NODES, IndexType>::~MappedNodePool() {
+    ::munmap(base, mappedSize);
+    ::close(fd);
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+uint64_t MappedNodePool<ElementType, NUM_NODES, IndexType>::fingerprint() {
+    // FNV-1a over the type name and the sizes that shape the node array
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    auto mix = [&hash](uint64_t byte) { hash = (hash ^ byte) * 0x100000001B3ULL; };
+    for (const char* p = typeid(ElementType).name(); *p; ++p)
+        mix(static_cast<unsigned char>(*p));
+    mix(sizeof(ElementType));
+    mix(alignof(ElementType));
+    mix(sizeof(IndexType));
+    return hash;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+void MappedNodePool<ElementType, NUM_NODES, IndexType>::map(int nodes) {
+    size_t size = fileSize(nodes);
+    if (::ftruncate(fd, off_t(size)) != 0)
+        throw system_error(errno, generic_category(), "MappedNodePool: cannot size the file");
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+        throw system_error(errno, generic_category(), "MappedNodePool: cannot map the file");
+    if (base)
+        ::munmap(base, mappedSize);
+    base = static_cast<unsigned char*>(p);
+    mappedSize = size;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+template<typename... Args>
+IndexType MappedNodePool<ElementType, NUM_NODES, IndexType>::newNode(Args&&... args) {
+    FileHeader* h = &header();
+    IndexType idx;
+    if (h->freeListHead != NULL_VALUE) {
+        idx = static_cast<IndexType>(h->freeListHead);
+        ::new (static_cast<void*>(nodes()[idx].data)) ElementType(std::forward<Args>(args)...);
+        h->freeListHead = nodes()[idx].next;
+    } else {
+        if (h->highWater == h->capacity) {
+            if (!growable || h->capacity == uint64_t(MAX_CAPACITY))
+                throw overflow_error("MappedNodePool: out of free nodes");
+            // Construct before growing, since args may refer into the pool
+            ElementType item(std::forward<Args>(args)...);
+            uint64_t doubled = h->capacity * 2;
+            reserve(doubled > uint64_t(MAX_CAPACITY) ? MAX_CAPACITY : int(doubled));
+            h = &header();
+            idx = static_cast<IndexType>(h->highWater);
+            ::new (static_cast<void*>(nodes()[idx].data)) ElementType(item);
+        } else {
+            idx = static_cast<IndexType>(h->highWater);
+            ::new (static_cast<void*>(nodes()[idx].data)) ElementType(std::forward<Args>(args)...);
+        }
+        ++h->highWater;
+    }
+    nodes()[idx].next = NULL_VALUE;
+    nodes()[idx].live = 1;
+    return idx;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+void MappedNodePool<ElementType, NUM_NODES, IndexType>::deleteNode(IndexType idx) {
+    if (!isLive(idx))
+        throw out_of_range("MappedNodePool: deleteNode index is not an allocated node");
+    nodes()[idx].live = 0;
+    nodes()[idx].next = static_cast<IndexType>(header().freeListHead);
+    header().freeListHead = idx;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+ElementType& MappedNodePool<ElementType, NUM_NODES, IndexType>::value(IndexType idx) {
+    return *std::launder(reinterpret_cast<ElementType*>(nodes()[idx].data));
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const ElementType& MappedNodePool<ElementType, NUM_NODES, IndexType>::value(IndexType idx) const {
+    return *std::launder(reinterpret_cast<const ElementType*>(nodes()[idx].data));
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+IndexType& MappedNodePool<ElementType, NUM_NODES, IndexType>::next(IndexType idx) {
+    return nodes()[idx].next;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+IndexType MappedNodePool<ElementType, NUM_NODES, IndexType>::next(IndexType idx) const {
+    return nodes()[idx].next;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+typename MappedNodePool<ElementType, NUM_NODES, IndexType>::Root&
+MappedNodePool<ElementType, NUM_NODES, IndexType>::root() {
+    return header().root;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+const typename MappedNodePool<ElementType, NUM_NODES, IndexType>::Root&
+MappedNodePool<ElementType, NUM_NODES, IndexType>::root() const {
+    return header().root;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+IndexType MappedNodePool<ElementType, NUM_NODES, IndexType>::getFreeListHead() const {
+    const FileHeader& h = header();
+    if (h.freeListHead != NULL_VALUE)
+        return static_cast<IndexType>(h.freeListHead);
+    return h.highWater < h.capacity ? static_cast<IndexType>(h.highWater) : NULL_VALUE;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+int MappedNodePool<ElementType, NUM_NODES, IndexType>::capacity() const {
+    return static_cast<int>(header().capacity);
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+bool MappedNodePool<ElementType, NUM_NODES, IndexType>::isGrowable() const {
+    return growable;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+bool MappedNodePool<ElementType, NUM_NODES, IndexType>::isValidIndex(IndexType idx) const {
+    return idx < header().highWater;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+bool MappedNodePool<ElementType, NUM_NODES, IndexType>::isLive(IndexType idx) const {
+    return isValidIndex(idx) && nodes()[idx].live != 0;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+void MappedNodePool<ElementType, NUM_NODES, IndexType>::reserve(int newCapacity) {
+    if (newCapacity > MAX_CAPACITY)
+        throw invalid_argument("MappedNodePool::reserve capacity too large");
+    if (newCapacity <= capacity())
+        return;
+    map(newCapacity);
+    header().capacity = newCapacity;
+}
+
+template<typename ElementType, int NUM_NODES, typename IndexType>
+void MappedNodePool<ElementType, NUM_NODES, IndexType>::sync() {
+    if (::msync(base, mappedSize, MS_SYNC) != 0)
+        throw system_error(errno, generic_category(), "MappedNodePool: sync failed");
+}
+
+#endif // MAPPEDNODEPOOL_H
@@ -1,148 +1,815 @@
 /*-- NodePool.h ------------------------------------------------------------
 
   This header file defines the NodePool class for managing a pool of nodes.
+  Nodes live in fixed-size chunks, so a node index stays valid for as long
+  as the node is allocated, even when the pool grows. Node data is kept in
+  raw storage: it is constructed by newNode and destroyed by deleteNode, so
+  free nodes hold no live objects. Nodes that have never been used are
+  handed out by a high-water index rather than threaded on the free list,
+  so construction is O(1) and untouched chunks are never allocated.
+  Links are stored as IndexType, by default the smallest unsigned type
+  that can index NUM_NODES nodes; its largest value is the NULL_VALUE
+  sentinel, so a pool holds at most MAX_CAPACITY nodes.
+  A bitmap with one bit per node records which nodes are allocated, so the
+  live nodes can be scanned in index order without following any links.
+  The Stats policy (see PoolStats.h) decides what the pool records about
+  its allocations; the default, NoStats, records nothing at no cost.
+  The Layout policy decides how a chunk arranges its nodes:
+     InterleavedLayout:  Each node keeps its data next to its link.
+     SplitLayout:        A chunk keeps all links in one array and all data
+                         in another, so link-only walks skip the payloads.
   Basic operations are:
      Constructor:        Initializes the node pool.
-     initializePool:     Initializes the free list and nodes.
+     Move Constructor:   Takes over the storage of another pool.
+     Move Assignment:    Replaces the storage with that of another pool.
+     Destructor:         Destroys the data of nodes still allocated.
+     initializePool:     Resets the pool so every node is free.
      newNode:            Allocates a new node from the pool.
      deleteNode:         Recycles a node back into the free list.
-     data:               Accessor to the node pool (mutable).
-     data (const):       Accessor to the node pool (immutable).
-     getFreeListHead:    Retrieves the index of the first free node.
+     value:              Accessor to the data stored in a node.
+     next:               Accessor to the link stored in a node.
+                         (value and next work the same for every layout.)
+     getFreeListHead:    Retrieves the index of the next node to be allocated.
+     capacity:           Returns the number of nodes the pool can hold.
+     isGrowable:         Checks if the pool grows when it runs out of nodes.
+     isValidIndex:       Checks if an index lies in the used part of the pool.
+     reserve:            Extends the pool to hold at least a given number of nodes.
+     shrinkToFit:        Releases trailing chunks that hold no live nodes.
+     compact:            Moves the allocated nodes to the front in a given order.
+     isLive:             Checks if a node is allocated.
+     forEachLive:        Applies a callable to every allocated node in index order.
+     liveWords:          Returns the number of 64-node words of the bitmap in use.
+     matchLive:          Tests a predicate on the allocated nodes of one word.
+     stats:              Returns a snapshot of the allocation counters.
 -------------------------------------------------------------------------*/
 
 #ifndef NODEPOOL_H
 #define NODEPOOL_H
 using namespace std;
 
+#include "PoolStats.h" // For the statistics policies
 #include <stdexcept>  // For exception handling
+#include <memory>     // For unique_ptr
+#include <vector>     // For the chunk table
+#include <new>        // For placement new and launder
+#include <utility>    // For forward
+#include <type_traits> // For is_trivially_destructible
+#include <cstdint>    // For the fixed-width index types
+#include <cstddef>    // For size_t
+#include <limits>     // For numeric_limits
+#include <cstring>    // For memcpy
+#include <algorithm>  // For fill
 
-template<typename ElementType, int NUM_NODES = 2048>
-class NodePool {
-public:
-    static const int NULL_VALUE = -1;  // Sentinel value indicating end of list
+// SmallestIndex selects the narrowest unsigned type whose values below the
+// maximum can index N nodes (the maximum is kept for the sentinel)
+template<long long N>
+struct SmallestIndex {
+    typedef typename conditional<(N <= 0xFF), uint8_t,
+            typename conditional<(N <= 0xFFFF), uint16_t, uint32_t>::type>::type type;
+};
+
+// InterleavedLayout stores each node's data and link side by side
+struct InterleavedLayout {
+    template<typename ElementType, typename IndexType, int CHUNK_SIZE>
+    struct Chunk {
+        struct NodeType {
+            alignas(ElementType) unsigned char data[sizeof(ElementType)];  // Raw storage for the data
+            IndexType next;    // Index of the next node
+        };
+
+        NodeType nodes[CHUNK_SIZE];
+
+        void* slot(int i) { return nodes[i].data; }
+        const void* slot(int i) const { return nodes[i].data; }
+        IndexType& next(int i) { return nodes[i].next; }
+        IndexType next(int i) const { return nodes[i].next; }
+    };
+};
 
-    // NodeType stores the data and a pointer to the next node in the pool
-    struct NodeType {
-        ElementType data;  // Data to be stored in the node
-        int next;          // Index of the next free node in the pool
+// SplitLayout stores the links of a chunk and its data in separate arrays
+struct SplitLayout {
+    template<typename ElementType, typename IndexType, int CHUNK_SIZE>
+    struct Chunk {
+        IndexType links[CHUNK_SIZE];  // Index of the next node, per node
+        alignas(ElementType) unsigned char slots[CHUNK_SIZE][sizeof(ElementType)];  // Raw data storage
+
+        void* slot(int i) { return slots[i]; }
+        const void* slot(int i) const { return slots[i]; }
+        IndexType& next(int i) { return links[i]; }
+        IndexType next(int i) const { return links[i]; }
     };
+};
+
+template<typename ElementType, int NUM_NODES = 2048, typename Layout = InterleavedLayout,
+         typename IndexType = typename SmallestIndex<NUM_NODES>::type, typename Stats = NoStats>
+class NodePool : private Stats {
+public:
+    typedef IndexType Index;
+    static const IndexType NULL_VALUE = static_cast<IndexType>(~IndexType(0));  // Sentinel value indicating end of list
+    static const int CHUNK_SIZE = 256; // Number of nodes per storage chunk
+    static const int MAX_CAPACITY =    // Largest number of nodes the index type can address
+        numeric_limits<IndexType>::max() < numeric_limits<int>::max()
+            ? static_cast<int>(numeric_limits<IndexType>::max())
+            : numeric_limits<int>::max();
+
+    // ChunkType holds CHUNK_SIZE nodes arranged as the layout dictates
+    typedef typename Layout::template Chunk<ElementType, IndexType, CHUNK_SIZE> ChunkType;
+    static const int WORD_BITS = 64;   // Nodes per word of the liveness bitmap
+    static_assert(CHUNK_SIZE % WORD_BITS == 0, "a bitmap word must not span two chunks");
 
     /***** Function Members ******/
 
     /***** Constructor *****/
-    NodePool();
+    explicit NodePool(int initialCapacity = NUM_NODES, bool growable = false);
     /*----------------------------------------------------------------------
       Constructor to initialize the node pool and set up the free list.
+      Precondition:  0 < initialCapacity <= MAX_CAPACITY.
+      Postcondition: A NodePool object has been created with room for
+                     initialCapacity nodes, all of them free. No storage is
+                     allocated until the first node is requested. A growable
+                     pool adds chunks on demand, up to MAX_CAPACITY nodes,
+                     instead of overflowing.
+      Throws:        invalid_argument if initialCapacity is out of range.
+    ----------------------------------------------------------------------*/
+
+    /***** Move Constructor *****/
+    NodePool(NodePool&& other) noexcept;
+    /*----------------------------------------------------------------------
+      Creates a pool by taking over the chunks and free list of another.
+      Precondition:  None
+      Postcondition: This pool holds other's nodes at the same indices.
+                     other is left empty with its capacity and growth mode.
+    ----------------------------------------------------------------------*/
+
+    /***** Move Assignment *****/
+    NodePool& operator=(NodePool&& other) noexcept;
+    /*----------------------------------------------------------------------
+      Replaces this pool's storage with that of another pool.
+      Precondition:  None
+      Postcondition: This pool's allocated data has been destroyed and it
+                     holds other's nodes. other is left empty.
+                     Returns a reference to this pool.
+    ----------------------------------------------------------------------*/
+
+    /***** Destructor *****/
+    ~NodePool();
+    /*----------------------------------------------------------------------
+      Destroys the pool.
       Precondition:  None
-      Postcondition: A NodePool object has been created, and the pool
-                     is initialized with free nodes.
+      Postcondition: The data of every node still allocated has been
+                     destroyed and all chunks have been released.
     ----------------------------------------------------------------------*/
 
     /***** initializePool *****/
     void initializePool();
     /*----------------------------------------------------------------------
-      Initializes the free list by linking all nodes together.
+      Resets the pool so that every node is free again.
       Precondition:  None
-      Postcondition: The node pool has been initialized, and freeListHead
-                     points to the first free node.
+      Postcondition: The data of any allocated node has been destroyed, the
+                     free list is empty and the high-water index is 0, so
+                     nodes are handed out again from index 0.
     ----------------------------------------------------------------------*/
 
     /***** newNode *****/
-    int newNode();
+    template<typename... Args>
+    IndexType newNode(Args&&... args);
     /*----------------------------------------------------------------------
-      Allocates a new node from the pool.
-      Precondition:  There must be at least one free node in the pool.
+      Allocates a new node from the pool and constructs its data in place
+      from args.
+      Precondition:  There must be at least one free node in the pool, or
+                     the pool must be growable. ElementType is constructible
+                     from args.
       Postcondition: A new node has been allocated and removed from the free list.
-                     Returns the index of the newly allocated node.
+                     Returns the index of the newly allocated node. If the
+                     constructor throws, the node stays on the free list.
+      Throws:        overflow_error if a fixed pool is out of free nodes, or
+                     a growable pool already holds MAX_CAPACITY nodes.
     ----------------------------------------------------------------------*/
 
     /***** deleteNode *****/
-    void deleteNode(int idx);
+    void deleteNode(IndexType idx);
     /*----------------------------------------------------------------------
       Recycles a node back into the pool and returns it to the free list.
-      Precondition:  The index must be valid (0 <= idx < NUM_NODES).
-      Postcondition: The node at the given index has been returned to the free list.
+      Precondition:  The index must be valid (0 <= idx < capacity()) and
+                     name an allocated node.
+      Postcondition: The node's data has been destroyed and the node at the
+                     given index has been returned to the free list.
+      Throws:        out_of_range if idx is not an allocated node, so a
+                     node freed twice is caught.
+    ----------------------------------------------------------------------*/
+
+    /***** value (mutable) *****/
+    ElementType& value(IndexType idx);
+    /*----------------------------------------------------------------------
+      Provides access to the data stored in a node.
+      Precondition:  idx names an allocated node.
+      Postcondition: Returns a reference to the node's data, allowing modification.
+    ----------------------------------------------------------------------*/
+
+    /***** value (immutable) *****/
+    const ElementType& value(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Provides access to the data stored in a node (read-only).
+      Precondition:  idx names an allocated node.
+      Postcondition: Returns a read-only reference to the node's data.
+    ----------------------------------------------------------------------*/
+
+    /***** next (mutable) *****/
+    IndexType& next(IndexType idx);
+    /*----------------------------------------------------------------------
+      Provides access to the link stored in a node.
+      Precondition:  0 <= idx < capacity().
+      Postcondition: Returns a reference to the node's next index, allowing
+                     modification.
     ----------------------------------------------------------------------*/
 
-    /***** data (mutable) *****/
-    NodeType* data();
+    /***** next (immutable) *****/
+    IndexType next(IndexType idx) const;
     /*----------------------------------------------------------------------
-      Provides access to the node pool.
+      Retrieves the link stored in a node.
+      Precondition:  0 <= idx < capacity().
+      Postcondition: Returns the node's next index.
+    ----------------------------------------------------------------------*/
+
+    /***** getFreeListHead *****/
+    IndexType getFreeListHead() const;
+    /*----------------------------------------------------------------------
+      Retrieves the index of the node the next newNode call will return.
       Precondition:  None
-      Postcondition: Returns a pointer to the array of nodes, allowing modification.
+      Postcondition: Returns the first recycled node if there is one,
+                     otherwise the high-water index, or NULL_VALUE if the
+                     pool is full.
     ----------------------------------------------------------------------*/
 
-    /***** data (immutable) *****/
-    const NodeType* data() const;
+    /***** capacity *****/
+    int capacity() const;
     /*----------------------------------------------------------------------
-      Provides access to the node pool (read-only).
+      Returns the number of nodes the pool can currently hold.
       Precondition:  None
-      Postcondition: Returns a pointer to the array of nodes, but access to
-                     data is read-only.
+      Postcondition: Returns the pool capacity.
     ----------------------------------------------------------------------*/
 
-    /***** getFreeListHead *****/
-    int getFreeListHead() const;
+    /***** isGrowable *****/
+    bool isGrowable() const;
+    /*----------------------------------------------------------------------
+      Checks if the pool adds chunks when it runs out of free nodes.
+      Precondition:  None
+      Postcondition: Returns true for a growable pool, false for a fixed one.
+    ----------------------------------------------------------------------*/
+
+    /***** isValidIndex *****/
+    bool isValidIndex(IndexType idx) const;
     /*----------------------------------------------------------------------
-      Retrieves the index of the first free node in the pool.
+      Checks if an index lies below the high-water index.
       Precondition:  None
-      Postcondition: Returns the index of the first free node (or NULL_VALUE if none).
+      Postcondition: Returns true if idx has been handed out by newNode at
+                     some point (it may since have been recycled), false
+                     otherwise. Only such indices have backing storage.
+    ----------------------------------------------------------------------*/
+
+    /***** reserve *****/
+    void reserve(int newCapacity);
+    /*----------------------------------------------------------------------
+      Extends the pool so it can hold at least newCapacity nodes.
+      Precondition:  newCapacity <= MAX_CAPACITY.
+      Postcondition: capacity() >= newCapacity and storage for that many
+                     nodes has been allocated; existing indices are unchanged.
+      Throws:        overflow_error if newCapacity exceeds MAX_CAPACITY.
+    ----------------------------------------------------------------------*/
+
+    /***** compact *****/
+    vector<IndexType> compact(const vector<IndexType>& order);
+    /*----------------------------------------------------------------------
+      Relocates the allocated nodes so that node order[i] ends up at index
+      i, moving each element at most once (plus one temporary per cycle of
+      the permutation).
+      Precondition:  order lists every allocated node exactly once.
+                     ElementType is move constructible.
+      Postcondition: Nodes occupy indices [0, order.size()) and every link
+                     between allocated nodes is rewritten to the new
+                     indices. The free list is empty and the high-water
+                     index is order.size(), so the free nodes form one
+                     contiguous tail. Returns the old-to-new mapping,
+                     indexed by old index, with NULL_VALUE for indices that
+                     were free.
+      Throws:        invalid_argument if order is not a permutation of the
+                     allocated nodes (the pool is left unchanged).
+    ----------------------------------------------------------------------*/
+
+    /***** shrinkToFit *****/
+    void shrinkToFit();
+    /*----------------------------------------------------------------------
+      Releases the chunks past the last one holding an allocated node.
+      Precondition:  None
+      Postcondition: Trailing chunks with no allocated nodes are freed.
+                     Free nodes past the last allocated one are taken off
+                     the free list and the high-water index is lowered to
+                     it. Allocated nodes keep their indices. capacity() is
+                     unchanged; freed chunks are allocated again on demand.
+    ----------------------------------------------------------------------*/
+
+    /***** isLive *****/
+    bool isLive(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Checks if a node is allocated.
+      Precondition:  None
+      Postcondition: Returns true if idx was handed out by newNode and has
+                     not been recycled since. O(1).
+    ----------------------------------------------------------------------*/
+
+    /***** forEachLive *****/
+    template<typename F>
+    void forEachLive(F&& visit);
+    template<typename F>
+    void forEachLive(F&& visit) const;
+    /*----------------------------------------------------------------------
+      Applies a callable to the data of every allocated node.
+      Precondition:  visit can be called with an ElementType& (const
+                     ElementType& for a const pool).
+      Postcondition: visit has been applied in index order, which need not
+                     be the order of any chain. Words of the bitmap with no
+                     allocated node are skipped whole.
+    ----------------------------------------------------------------------*/
+
+    /***** liveWords *****/
+    int liveWords() const;
+    /*----------------------------------------------------------------------
+      Returns the number of bitmap words that can hold allocated nodes.
+      Precondition:  None
+      Postcondition: Word w covers nodes [w * WORD_BITS, (w + 1) * WORD_BITS);
+                     every allocated node lies in a word below the result.
+    ----------------------------------------------------------------------*/
+
+    /***** matchLive *****/
+    template<typename Pred>
+    uint64_t matchLive(int word, Pred pred) const;
+    /*----------------------------------------------------------------------
+      Tests a predicate on the allocated nodes of one bitmap word.
+      Precondition:  0 <= word < liveWords(). pred can be called with a
+                     const ElementType&.
+      Postcondition: Returns a mask with bit j set if node
+                     word * WORD_BITS + j is allocated and pred holds for
+                     its data. For arithmetic ElementType pred is evaluated
+                     on every slot of the word without branching, so the
+                     loop vectorizes, and the result is masked by the
+                     bitmap; otherwise pred only sees allocated nodes.
+    ----------------------------------------------------------------------*/
+
+    /***** stats *****/
+    PoolStats stats() const;
+    /*----------------------------------------------------------------------
+      Returns a snapshot of the pool's counters.
+      Precondition:  None
+      Postcondition: live, highWater and capacity always describe the
+                     pool. allocations, frees, failedAllocations and
+                     peakLive are filled in by the Stats policy, and are 0
+                     with NoStats.
     ----------------------------------------------------------------------*/
 
 private:
-    NodeType pool[NUM_NODES];   // Array of nodes in the pool
-    int freeListHead;           // Index of the first free node in the pool
+    /***** freeMap *****/
+    vector<bool> freeMap() const;
+    /*----------------------------------------------------------------------
+      Marks the nodes that are not allocated.
+      Precondition:  None
+      Postcondition: Returns a vector of capacity() flags, true for nodes on
+                     the free list or at or above the high-water index.
+    ----------------------------------------------------------------------*/
+
+    /***** addChunk *****/
+    void addChunk();
+    /*----------------------------------------------------------------------
+      Appends a storage chunk and its words of the bitmap.
+      Precondition:  None
+      Postcondition: One more chunk exists, with all its nodes marked free.
+                     Arithmetic data is zeroed so matchLive never reads
+                     indeterminate values.
+    ----------------------------------------------------------------------*/
+
+    /***** destroyAll *****/
+    void destroyAll();
+    /*----------------------------------------------------------------------
+      Destroys the data of every allocated node.
+      Precondition:  None
+      Postcondition: No node holds a live object; links are unchanged.
+    ----------------------------------------------------------------------*/
+
+    /***** slot *****/
+    void* slot(IndexType idx);
+    const void* slot(IndexType idx) const;
+    /*----------------------------------------------------------------------
+      Maps an index to the raw data storage of its node.
+      Precondition:  0 <= idx < capacity() and the node's chunk exists.
+      Postcondition: Returns the address where the node's data lives.
+    ----------------------------------------------------------------------*/
+
+    vector<unique_ptr<ChunkType>> chunks;  // Storage chunks of CHUNK_SIZE nodes
+    int nodeCapacity;           // Number of usable nodes in the pool
+    bool growable;              // True if the pool grows instead of overflowing
+    IndexType freeListHead;     // Index of the first recycled node in the pool
+    int highWater;              // Index of the first node never handed out
+    vector<uint64_t> live;      // Liveness bitmap, WORD_BITS nodes per word
 
 };  //--- end of NodePool class
 
 /* IMPLEMENTATION STARTS HERE */
 
-template<typename ElementType, int NUM_NODES>
-NodePool<ElementType, NUM_NODES>::NodePool() {
-    initializePool();
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const IndexType NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::NULL_VALUE;
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const int NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::CHUNK_SIZE;
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const int NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::MAX_CAPACITY;
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const int NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::WORD_BITS;
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::NodePool(int initialCapacity, bool growable)
+    : chunks(), nodeCapacity(initialCapacity), growable(growable),
+      freeListHead(NULL_VALUE), highWater(0) {
+    if (initialCapacity <= 0 || initialCapacity > MAX_CAPACITY)
+        throw invalid_argument("NodePool: capacity out of range");
 }
 
-template<typename ElementType, int NUM_NODES>
-void NodePool<ElementType, NUM_NODES>::initializePool() {
-    for (int i = 0; i < NUM_NODES - 1; ++i) {
-        pool[i].next = i + 1;
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::NodePool(NodePool&& other) noexcept
+    : Stats(std::move(static_cast<Stats&>(other))), chunks(std::move(other.chunks)), nodeCapacity(other.nodeCapacity),
+      growable(other.growable), freeListHead(other.freeListHead),
+      highWater(other.highWater), live(std::move(other.live)) {
+    other.chunks.clear();
+    other.freeListHead = NULL_VALUE;
+    other.highWater = 0;
+    other.live.clear();
+    static_cast<Stats&>(other) = Stats();
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>&
+NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::operator=(NodePool&& other) noexcept {
+    if (this != &other) {
+        destroyAll();
+        chunks = std::move(other.chunks);
+        nodeCapacity = other.nodeCapacity;
+        growable = other.growable;
+        freeListHead = other.freeListHead;
+        highWater = other.highWater;
+        live = std::move(other.live);
+        static_cast<Stats&>(*this) = std::move(static_cast<Stats&>(other));
+        other.chunks.clear();
+        other.freeListHead = NULL_VALUE;
+        other.highWater = 0;
+        other.live.clear();
+        static_cast<Stats&>(other) = Stats();
     }
-    pool[NUM_NODES - 1].next = NULL_VALUE;
-    freeListHead = 0;
+    return *this;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::~NodePool() {
+    destroyAll();
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::initializePool() {
+    destroyAll();
+    freeListHead = NULL_VALUE;
+    highWater = 0;
+    fill(live.begin(), live.end(), 0);
+    this->onReset();
 }
 
-template<typename ElementType, int NUM_NODES>
-int NodePool<ElementType, NUM_NODES>::newNode() {
-    if (freeListHead == NULL_VALUE)
-        throw overflow_error("NodePool: out of free nodes");
-    int index = freeListHead;
-    freeListHead = pool[index].next;
-    pool[index].next = NULL_VALUE;
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename... Args>
+IndexType NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::newNode(Args&&... args) {
+    if (freeListHead != NULL_VALUE) {
+        IndexType index = freeListHead;
+        ::new (slot(index)) ElementType(std::forward<Args>(args)...);
+        freeListHead = next(index);
+        next(index) = NULL_VALUE;
+        live[index / WORD_BITS] |= uint64_t(1) << (index % WORD_BITS);
+        this->onAllocate();
+        return index;
+    }
+
+    if (highWater == nodeCapacity) {
+        if (!growable || nodeCapacity == MAX_CAPACITY) {
+            this->onAllocateFailed();
+            throw overflow_error("NodePool: out of free nodes");
+        }
+        int grown = (nodeCapacity / CHUNK_SIZE + 1) * CHUNK_SIZE;
+        nodeCapacity = (grown > MAX_CAPACITY || grown <= 0) ? MAX_CAPACITY : grown;
+    }
+    if (static_cast<size_t>(highWater / CHUNK_SIZE) == chunks.size())
+        addChunk();
+    IndexType index = static_cast<IndexType>(highWater);
+    ::new (slot(index)) ElementType(std::forward<Args>(args)...);
+    next(index) = NULL_VALUE;
+    live[index / WORD_BITS] |= uint64_t(1) << (index % WORD_BITS);
+    ++highWater;
+    this->onAllocate();
     return index;
 }
 
-template<typename ElementType, int NUM_NODES>
-void NodePool<ElementType, NUM_NODES>::deleteNode(int index) {
-    if (index < 0 || index >= NUM_NODES)
-        throw out_of_range("NodePool: deleteNode index out of range");
-    pool[index].next = freeListHead;
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::deleteNode(IndexType index) {
+    if (!isLive(index))
+        throw out_of_range("NodePool: deleteNode index is not an allocated node");
+    value(index).~ElementType();
+    next(index) = freeListHead;
     freeListHead = index;
+    live[index / WORD_BITS] &= ~(uint64_t(1) << (index % WORD_BITS));
+    this->onFree();
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+ElementType& NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::value(IndexType idx) {
+    return *std::launder(static_cast<ElementType*>(slot(idx)));
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const ElementType& NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::value(IndexType idx) const {
+    return *std::launder(static_cast<const ElementType*>(slot(idx)));
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType& NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::next(IndexType idx) {
+    size_t i = static_cast<size_t>(idx);
+    return chunks[i / CHUNK_SIZE]->next(i % CHUNK_SIZE);
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::next(IndexType idx) const {
+    size_t i = static_cast<size_t>(idx);
+    return chunks[i / CHUNK_SIZE]->next(i % CHUNK_SIZE);
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+IndexType NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::getFreeListHead() const {
+    if (freeListHead != NULL_VALUE)
+        return freeListHead;
+    return highWater < nodeCapacity ? static_cast<IndexType>(highWater) : NULL_VALUE;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+int NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::capacity() const {
+    return nodeCapacity;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+bool NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::isGrowable() const {
+    return growable;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+bool NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::isValidIndex(IndexType idx) const {
+    long long i = static_cast<long long>(idx);
+    return i >= 0 && i < highWater;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::reserve(int newCapacity) {
+    if (newCapacity > MAX_CAPACITY)
+        throw overflow_error("NodePool: capacity exceeds the index range");
+    while (static_cast<int>(chunks.size()) * CHUNK_SIZE < newCapacity)
+        addChunk();
+    if (newCapacity > nodeCapacity)
+        nodeCapacity = newCapacity;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::shrinkToFit() {
+    vector<bool> isFree = freeMap();
+
+    int used = highWater;
+    while (used > 0 && isFree[used - 1])
+        --used;
+    int keptChunks = (used + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    // Nodes past the last allocated one go back to the high-water region
+    IndexType prev = NULL_VALUE;
+    for (IndexType ptr = freeListHead; ptr != NULL_VALUE; ptr = next(ptr)) {
+        if (static_cast<long long>(ptr) >= used)
+            continue;
+        if (prev == NULL_VALUE)
+            freeListHead = ptr;
+        else
+            next(prev) = ptr;
+        prev = ptr;
+    }
+    if (prev == NULL_VALUE)
+        freeListHead = NULL_VALUE;
+    else
+        next(prev) = NULL_VALUE;
+
+    highWater = used;
+    // newNode adds the released chunks back as the high-water index reaches them
+    if (chunks.size() > static_cast<size_t>(keptChunks)) {
+        chunks.resize(keptChunks);
+        live.resize(keptChunks * (CHUNK_SIZE / WORD_BITS));
+    }
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+vector<IndexType> NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::compact(const vector<IndexType>& order) {
+    vector<bool> isFree = freeMap();
+    size_t n = order.size();
+    vector<IndexType> remap(highWater, NULL_VALUE);
+    for (size_t i = 0; i < n; ++i) {
+        size_t from = static_cast<size_t>(order[i]);
+        if (from >= remap.size() || isFree[from] || remap[from] != NULL_VALUE)
+            throw invalid_argument("NodePool::compact order is not a permutation of the allocated nodes");
+        remap[from] = static_cast<IndexType>(i);
+    }
+    for (int i = 0; i < highWater; ++i) {
+        if (!isFree[i] && remap[i] == NULL_VALUE)
+            throw invalid_argument("NodePool::compact order is not a permutation of the allocated nodes");
+    }
+
+    // Links are rewritten once the data has moved
+    vector<IndexType> links(n);
+    for (size_t i = 0; i < n; ++i) {
+        size_t to = static_cast<size_t>(next(order[i]));
+        links[i] = to < remap.size() ? remap[to] : NULL_VALUE;
+    }
+
+    auto relocate = [this](IndexType from, IndexType to) {
+        ::new (slot(to)) ElementType(std::move(value(from)));
+        value(from).~ElementType();
+    };
+    vector<bool> placed(n, false);
+    for (size_t i = 0; i < n; ++i)
+        placed[i] = (static_cast<size_t>(order[i]) == i);
+
+    // Chains that end in a free target: fill it, then the slot just vacated
+    for (size_t t = 0; t < n; ++t) {
+        if (!isFree[t])
+            continue;
+        size_t hole = t;
+        while (true) {
+            size_t from = static_cast<size_t>(order[hole]);
+            relocate(static_cast<IndexType>(from), static_cast<IndexType>(hole));
+            isFree[hole] = false;
+            placed[hole] = true;
+            isFree[from] = true;
+            if (from >= n || placed[from])
+                break;
+            hole = from;
+        }
+    }
+    // What is left are cycles among live targets; each needs one temporary
+    for (size_t s = 0; s < n; ++s) {
+        if (placed[s])
+            continue;
+        ElementType saved(std::move(value(static_cast<IndexType>(s))));
+        value(static_cast<IndexType>(s)).~ElementType();
+        size_t hole = s;
+        while (static_cast<size_t>(order[hole]) != s) {
+            size_t from = static_cast<size_t>(order[hole]);
+            relocate(static_cast<IndexType>(from), static_cast<IndexType>(hole));
+            placed[hole] = true;
+            hole = from;
+        }
+        ::new (slot(static_cast<IndexType>(hole))) ElementType(std::move(saved));
+        placed[hole] = true;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+        next(static_cast<IndexType>(i)) = links[i];
+    freeListHead = NULL_VALUE;
+    highWater = static_cast<int>(n);
+    fill(live.begin(), live.end(), 0);
+    for (size_t w = 0; w < n / WORD_BITS; ++w)
+        live[w] = ~uint64_t(0);
+    if (n % WORD_BITS)
+        live[n / WORD_BITS] = (uint64_t(1) << (n % WORD_BITS)) - 1;
+    return remap;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+bool NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::isLive(IndexType idx) const {
+    size_t i = static_cast<size_t>(idx);
+    return i < static_cast<size_t>(highWater) && (live[i / WORD_BITS] >> (i % WORD_BITS) & 1);
 }
 
-template<typename ElementType, int NUM_NODES>
-typename NodePool<ElementType, NUM_NODES>::NodeType* NodePool<ElementType, NUM_NODES>::data() {
-    return pool;
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename F>
+void NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::forEachLive(F&& visit) {
+    int words = liveWords();
+    for (int w = 0; w < words; ++w) {
+        ChunkType& chunk = *chunks[w / (CHUNK_SIZE / WORD_BITS)];
+        int first = (w % (CHUNK_SIZE / WORD_BITS)) * WORD_BITS;
+        uint64_t mask = live[w];
+        for (int j = first; mask != 0; ++j, mask >>= 1) {
+            if (mask & 1)
+                visit(*std::launder(static_cast<ElementType*>(chunk.slot(j))));
+        }
+    }
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename F>
+void NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::forEachLive(F&& visit) const {
+    int words = liveWords();
+    for (int w = 0; w < words; ++w) {
+        const ChunkType& chunk = *chunks[w / (CHUNK_SIZE / WORD_BITS)];
+        int first = (w % (CHUNK_SIZE / WORD_BITS)) * WORD_BITS;
+        uint64_t mask = live[w];
+        for (int j = first; mask != 0; ++j, mask >>= 1) {
+            if (mask & 1)
+                visit(*std::launder(static_cast<const ElementType*>(chunk.slot(j))));
+        }
+    }
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+int NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::liveWords() const {
+    return (highWater + WORD_BITS - 1) / WORD_BITS;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+template<typename Pred>
+uint64_t NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::matchLive(int word, Pred pred) const {
+    uint64_t mask = live[word];
+    if (mask == 0)
+        return 0;
+    const ChunkType& chunk = *chunks[word / (CHUNK_SIZE / WORD_BITS)];
+    int first = (word % (CHUNK_SIZE / WORD_BITS)) * WORD_BITS;
+    uint64_t hits = 0;
+    if constexpr (is_arithmetic<ElementType>::value) {
+        // Free slots hold stale or zeroed values; the mask discards them.
+        // Comparing into bytes first keeps the compare loop vectorizable.
+        unsigned char match[WORD_BITS];
+        for (int j = 0; j < WORD_BITS; ++j) {
+            ElementType v;
+            memcpy(&v, chunk.slot(first + j), sizeof(ElementType));
+            match[j] = pred(v) ? 1 : 0;
+        }
+        for (int j = 0; j < WORD_BITS; ++j)
+            hits |= uint64_t(match[j]) << j;
+        return hits & mask;
+    } else {
+        for (int j = 0; mask != 0; ++j, mask >>= 1) {
+            if ((mask & 1) && pred(*std::launder(static_cast<const ElementType*>(chunk.slot(first + j)))))
+                hits |= uint64_t(1) << j;
+        }
+        return hits;
+    }
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+PoolStats NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::stats() const {
+    PoolStats s = PoolStats();
+    for (uint64_t word : live) {
+        for (; word != 0; word &= word - 1)
+            ++s.live;
+    }
+    s.highWater = highWater;
+    s.capacity = nodeCapacity;
+    this->fillPool(s);
+    return s;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+vector<bool> NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::freeMap() const {
+    vector<bool> isFree(nodeCapacity, true);
+    for (int i = 0; i < highWater; ++i)
+        isFree[i] = !(live[i / WORD_BITS] >> (i % WORD_BITS) & 1);
+    return isFree;
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::addChunk() {
+    if constexpr (is_arithmetic<ElementType>::value)
+        chunks.emplace_back(new ChunkType());
+    else
+        chunks.emplace_back(new ChunkType);
+    live.resize(chunks.size() * (CHUNK_SIZE / WORD_BITS), 0);
+}
+
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::destroyAll() {
+    if (is_trivially_destructible<ElementType>::value)
+        return;
+    vector<bool> isFree = freeMap();
+    for (int i = 0; i < highWater; ++i) {
+        if (!isFree[i])
+            value(static_cast<IndexType>(i)).~ElementType();
+    }
 }
 
-template<typename ElementType, int NUM_NODES>
-const typename NodePool<ElementType, NUM_NODES>::NodeType* NodePool<ElementType, NUM_NODES>::data() const {
-    return pool;
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+void* NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::slot(IndexType idx) {
+    size_t i = static_cast<size_t>(idx);
+    return chunks[i / CHUNK_SIZE]->slot(i % CHUNK_SIZE);
 }
 
-template<typename ElementType, int NUM_NODES>
-int NodePool<ElementType, NUM_NODES>::getFreeListHead() const {
-    return freeListHead;
+template<typename ElementType, int NUM_NODES, typename Layout, typename IndexType, typename Stats>
+const void* NodePool<ElementType, NUM_NODES, Layout, IndexType, Stats>::slot(IndexType idx) const {
+    size_t i = static_cast<size_t>(idx);
+    return chunks[i / CHUNK_SIZE]->slot(i % CHUNK_SIZE);
 }
 
 #endif // NODEPOOL_H
@@ -0,0 +1,359 @@
+/*-- PersistentList.h -----------------------------------------------------
+
+This header file defines the PersistentList class, a singly linked list
+whose nodes live in a MappedNodePool file. Its head, tail and count are
+kept in the file header, so opening the file again restores the list in
+O(1), without rebuilding it. Elements must be trivially copyable.
+Changes reach the file through the mapping; sync forces them to disk.
+  Basic operations are:
+     Constructor:        Opens the list stored in a file, or creates it.
+     isEmpty:            Checks if the list is empty.
+     forEach:            Applies a callable to each element in order.
+     size:               Returns the number of elements in the list.
+     find:               Finds a node by its value.
+     contains:           Checks if a value is in the list.
+     clear:              Clears the list by deleting all elements.
+     insertFront:        Inserts an element at the front of the list.
+     deleteFront:        Deletes the front element of the list.
+     insertAfter:        Inserts an element after a given position.
+     deleteAfter:        Deletes an element after a given position.
+     pushBack:           Inserts an element at the end of the list in O(1).
+     remove:             Removes a node by its value.
+     getFreeListHead:    Returns the index of the first free node in the pool.
+     capacity:           Returns the number of nodes the pool can hold.
+     sync:               Writes the list back to its file.
+     printList:          Prints list contents to std::cout.
+     operator<<:         Prints list contents to any std::ostream.
+-------------------------------------------------------------------------*/
+
+#ifndef PERSISTENTLIST_H
+#define PERSISTENTLIST_H
+
+#include "MappedNodePool.h"
+#include <stdexcept>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+template<typename T, int NUM_NODES = 2048,
+         typename IndexType = typename SmallestIndex<NUM_NODES>::type>
+class PersistentList {
+public:
+    typedef MappedNodePool<T, NUM_NODES, IndexType> PoolType;
+    static const IndexType NULL_VALUE = PoolType::NULL_VALUE;
+
+    /***** Function Members ******/
+
+    /***** Constructor *****/
+    explicit PersistentList(const string& path, int initialCapacity = NUM_NODES, bool growable = false);
+    /*----------------------------------------------------------------------
+      Opens the list stored in the file at path, or creates an empty one.
+      Precondition:  0 < initialCapacity <= PoolType::MAX_CAPACITY.
+      Postcondition: The list holds the elements it held when the file was
+                     last written. See MappedNodePool for the capacity,
+                     growth mode and the errors thrown.
+    ----------------------------------------------------------------------*/
+
+    PersistentList(const PersistentList&) = delete;
+    PersistentList& operator=(const PersistentList&) = delete;
+
+    /***** isEmpty *****/
+    bool isEmpty() const;
+    /*----------------------------------------------------------------------
+      Checks if the list is empty.
+      Precondition:  None
+      Postcondition: Returns true if the list is empty, false otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** forEach *****/
+    template<typename F>
+    void forEach(F&& visit) const;
+    /*----------------------------------------------------------------------
+      Applies a callable to each element in the list.
+      Precondition:  visit can be called with a const T&.
+      Postcondition: visit has been applied to each element in order.
+    ----------------------------------------------------------------------*/
+
+    /***** size *****/
+    int size() const;
+    /*----------------------------------------------------------------------
+      Returns the number of elements in the list.
+      Precondition:  None
+      Postcondition: Returns the count of elements in the list in O(1).
+    ----------------------------------------------------------------------*/
+
+    /***** find *****/
+    IndexType find(const T& item) const;
+    /*----------------------------------------------------------------------
+      Searches for an item in the list.
+      Precondition:  None
+      Postcondition: Returns the index of the item if found, NULL_VALUE otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** contains *****/
+    bool contains(const T& item) const;
+    /*----------------------------------------------------------------------
+      Checks if an item is in the list.
+      Precondition:  None
+      Postcondition: Returns true if some element equals item.
+    ----------------------------------------------------------------------*/
+
+    /***** clear *****/
+    void clear();
+    /*----------------------------------------------------------------------
+      Removes all elements from the list.
+      Precondition:  None
+      Postcondition: The list is empty and its nodes are back on the free list.
+    ----------------------------------------------------------------------*/
+
+    /***** insertFront *****/
+    void insertFront(const T& item);
+    /*----------------------------------------------------------------------
+      Inserts an element at the front of the list.
+      Precondition:  The pool has a free node or is growable.
+      Postcondition: item is the first element of the list.
+    ----------------------------------------------------------------------*/
+
+    /***** deleteFront *****/
+    void deleteFront();
+    /*----------------------------------------------------------------------
+      Deletes the front element of the list.
+      Precondition:  The list is not empty.
+      Postcondition: The first element has been removed.
+      Throws:        underflow_error if the list is empty.
+    ----------------------------------------------------------------------*/
+
+    /***** insertAfter *****/
+    void insertAfter(IndexType pos, const T& item);
+    /*----------------------------------------------------------------------
+      Inserts an element after a given position.
+      Precondition:  pos names a node of the list.
+      Postcondition: item follows the node at pos.
+      Throws:        underflow_error if the list is empty, out_of_range if
+                     pos is not an allocated node.
+    ----------------------------------------------------------------------*/
+
+    /***** deleteAfter *****/
+    void deleteAfter(IndexType pos);
+    /*----------------------------------------------------------------------
+      Deletes the element after a given position.
+      Precondition:  pos names a node of the list that has a successor.
+      Postcondition: The successor of pos has been removed.
+      Throws:        underflow_error if the list is empty, out_of_range if
+                     pos is not an allocated node or has no successor.
+    ----------------------------------------------------------------------*/
+
+    /***** pushBack *****/
+    void pushBack(const T& item);
+    /*----------------------------------------------------------------------
+      Inserts an element at the end of the list.
+      Precondition:  The pool has a free node or is growable.
+      Postcondition: item is the last element of the list. O(1).
+    ----------------------------------------------------------------------*/
+
+    /***** remove *****/
+    bool remove(const T& item);
+    /*----------------------------------------------------------------------
+      Removes the first node holding item.
+      Precondition:  None
+      Postcondition: Returns true if a node was removed, false otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** getFreeListHead *****/
+    IndexType getFreeListHead() const;
+    /*----------------------------------------------------------------------
+      Returns the index of the node the next insert will use.
+    ----------------------------------------------------------------------*/
+
+    /***** capacity *****/
+    int capacity() const;
+    /*----------------------------------------------------------------------
+      Returns the number of nodes the pool can currently hold.
+    ----------------------------------------------------------------------*/
+
+    /***** sync *****/
+    void sync();
+    /*----------------------------------------------------------------------
+      Writes the list back to its file and waits for the write.
+      Precondition:  None
+      Postcondition: Reopening the file restores the current list, even
+                     after a crash.
+    ----------------------------------------------------------------------*/
+
+    /***** printList *****/
+    void printList() const;
+    /*----------------------------------------------------------------------
+      Prints the list contents to standard output.
+      Precondition:  None
+      Postcondition: List elements and free list head are printed to cout.
+    ----------------------------------------------------------------------*/
+
+private:
+    // The root lives in the file and moves when the file grows, so it is
+    // looked up again after every allocation
+    IndexType head() const { return static_cast<IndexType>(pool.root().head); }
+    IndexType tail() const { return static_cast<IndexType>(pool.root().tail); }
+
+    PoolType pool;   // File-backed node pool holding the list and its root
+};
+
+// Implementation
+
+template<typename T, int NUM_NODES, typename IndexType>
+const IndexType PersistentList<T, NUM_NODES, IndexType>::NULL_VALUE;
+
+template<typename T, int NUM_NODES, typename IndexType>
+PersistentList<T, NUM_NODES, IndexType>::PersistentList(const string& path, int initialCapacity, bool growable)
+    : pool(path, initialCapacity, growable) {}
+
+template<typename T, int NUM_NODES, typename IndexType>
+bool PersistentList<T, NUM_NODES, IndexType>::isEmpty() const {
+    return head() == NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+template<typename F>
+void PersistentList<T, NUM_NODES, IndexType>::forEach(F&& visit) const {
+    for (IndexType ptr = head(); ptr != NULL_VALUE; ptr = pool.next(ptr))
+        visit(pool.value(ptr));
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+int PersistentList<T, NUM_NODES, IndexType>::size() const {
+    return static_cast<int>(pool.root().count);
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+IndexType PersistentList<T, NUM_NODES, IndexType>::find(const T& item) const {
+    for (IndexType ptr = head(); ptr != NULL_VALUE; ptr = pool.next(ptr))
+        if (pool.value(ptr) == item)
+            return ptr;
+    return NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+bool PersistentList<T, NUM_NODES, IndexType>::contains(const T& item) const {
+    return find(item) != NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void PersistentList<T, NUM_NODES, IndexType>::clear() {
+    while (!isEmpty()) deleteFront();
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void PersistentList<T, NUM_NODES, IndexType>::insertFront(const T& item) {
+    IndexType idx = pool.newNode(item);
+    typename PoolType::Root& r = pool.root();
+    pool.next(idx) = static_cast<IndexType>(r.head);
+    if (r.head == NULL_VALUE)
+        r.tail = idx;
+    r.head = idx;
+    ++r.count;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void PersistentList<T, NUM_NODES, IndexType>::deleteFront() {
+    if (isEmpty())
+        throw underflow_error("PersistentList::deleteFront() on empty list");
+    typename PoolType::Root& r = pool.root();
+    IndexType old = static_cast<IndexType>(r.head);
+    r.head = pool.next(old);
+    if (r.head == NULL_VALUE)
+        r.tail = NULL_VALUE;
+    --r.count;
+    pool.deleteNode(old);
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void PersistentList<T, NUM_NODES, IndexType>::insertAfter(IndexType pos, const T& item) {
+    if (isEmpty())
+        throw underflow_error("PersistentList::insertAfter() on empty list");
+    if (!pool.isLive(pos))
+        throw out_of_range("PersistentList::insertAfter invalid position");
+    IndexType idx = pool.newNode(item);
+    typename PoolType::Root& r = pool.root();
+    pool.next(idx) = pool.next(pos);
+    pool.next(pos) = idx;
+    if (pos == r.tail)
+        r.tail = idx;
+    ++r.count;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void PersistentList<T, NUM_NODES, IndexType>::deleteAfter(IndexType pos) {
+    if (isEmpty())
+        throw underflow_error("PersistentList::deleteAfter() on empty list");
+    if (!pool.isLive(pos))
+        throw out_of_range("PersistentList::deleteAfter invalid position");
+    IndexType tgt = pool.next(pos);
+    if (tgt == NULL_VALUE)
+        throw out_of_range("PersistentList::deleteAfter no successor");
+    typename PoolType::Root& r = pool.root();
+    pool.next(pos) = pool.next(tgt);
+    if (tgt == r.tail)
+        r.tail = pos;
+    --r.count;
+    pool.deleteNode(tgt);
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void PersistentList<T, NUM_NODES, IndexType>::pushBack(const T& item) {
+    IndexType idx = pool.newNode(item);
+    typename PoolType::Root& r = pool.root();
+    if (r.head == NULL_VALUE)
+        r.head = idx;
+    else
+        pool.next(static_cast<IndexType>(r.tail)) = idx;
+    r.tail = idx;
+    ++r.count;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+bool PersistentList<T, NUM_NODES, IndexType>::remove(const T& item) {
+    if (isEmpty()) return false;
+    if (pool.value(head()) == item) {
+        deleteFront();
+        return true;
+    }
+    IndexType prev = head(), curr = pool.next(prev);
+    while (curr != NULL_VALUE && !(pool.value(curr) == item)) {
+        prev = curr;
+        curr = pool.next(prev);
+    }
+    if (curr == NULL_VALUE) return false;
+    deleteAfter(prev);
+    return true;
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+IndexType PersistentList<T, NUM_NODES, IndexType>::getFreeListHead() const {
+    return pool.getFreeListHead();
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+int PersistentList<T, NUM_NODES, IndexType>::capacity() const {
+    return pool.capacity();
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void PersistentList<T, NUM_NODES, IndexType>::sync() {
+    pool.sync();
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+void PersistentList<T, NUM_NODES, IndexType>::printList() const {
+    cout << "List contents: ";
+    forEach([](const T& s) { cout << s << " "; });
+    cout << "\nFree-list head index: " << +getFreeListHead() << "\n";
+}
+
+template<typename T, int NUM_NODES, typename IndexType>
+ostream& operator<<(ostream& os, const PersistentList<T, NUM_NODES, IndexType>& lst) {
+    lst.forEach([&os](const T& s) { os << s << " "; });
+    os << "\nFree-list head index: " << +lst.getFreeListHead() << "\n";
+    return os;
+}
+
+#endif // PERSISTENTLIST_H
@@ -0,0 +1,107 @@
+/*-- PoolStats.h ----------------------------------------------------------
+
+  This header file defines the statistics policies for NodePool and List
+  and the snapshots their stats() functions return. The policy is a
+  template parameter, so the choice is made at compile time:
+     NoStats:            Records nothing. Its hooks are empty inline
+                         functions and it adds no data members, so a pool
+                         or list using it costs nothing extra.
+     CountingStats:      Counts allocations, frees, failed allocations,
+                         live and peak live nodes, and the links followed
+                         by each kind of search.
+  A pool or list inherits privately from its policy and calls the hooks
+  below; a custom policy only has to provide the same members.
+     onAllocate:         A node was handed out.
+     onFree:             A node was returned.
+     onAllocateFailed:   newNode ran out of nodes.
+     onReset:            Every node was returned at once.
+     onSearch:           A search of a given kind followed a number of links.
+     fillPool/fillList:  Copy the counters into a snapshot.
+-------------------------------------------------------------------------*/
+
+#ifndef POOLSTATS_H
+#define POOLSTATS_H
+
+using namespace std;
+
+// PoolStats is a snapshot of a pool's allocation counters. Counters a
+// policy does not record are 0
+struct PoolStats {
+    long long allocations;        // Nodes handed out by newNode
+    long long frees;              // Nodes returned by deleteNode
+    long long failedAllocations;  // newNode calls that threw overflow_error
+    long long live;               // Nodes allocated now
+    long long peakLive;           // Most nodes allocated at any one time
+    int highWater;                // Distinct nodes ever handed out
+    int capacity;                 // Nodes the pool can hold now
+};
+
+// ListStats is a snapshot of a list's search counters and of its pool
+struct ListStats {
+    enum Search { FIND, INSERT_SORTED, REMOVE, SEARCH_KINDS };
+
+    PoolStats pool;                   // Counters of the list's pool
+    long long searches[SEARCH_KINDS]; // Searches of each kind
+    long long hops[SEARCH_KINDS];     // Links followed by those searches
+    double fragmentation;             // Fraction of links that are not to the next slot
+
+    double hopsPerSearch(Search kind) const {
+        return searches[kind] ? double(hops[kind]) / double(searches[kind]) : 0.0;
+    }
+};
+
+// NoStats records nothing
+struct NoStats {
+    static const bool ENABLED = false;
+
+    void onAllocate() const {}
+    void onFree() const {}
+    void onAllocateFailed() const {}
+    void onReset() const {}
+    void onSearch(ListStats::Search, long long) const {}
+    void fillPool(PoolStats&) const {}
+    void fillList(ListStats&) const {}
+};
+
+// CountingStats keeps plain counters. They are mutable because searches
+// through const member functions are counted too
+struct CountingStats {
+    static const bool ENABLED = true;
+
+    CountingStats() : allocations(0), frees(0), failedAllocations(0), live(0), peakLive(0) {
+        for (int kind = 0; kind < ListStats::SEARCH_KINDS; ++kind)
+            searches[kind] = hops[kind] = 0;
+    }
+
+    void onAllocate() {
+        ++allocations;
+        if (++live > peakLive)
+            peakLive = live;
+    }
+    void onFree() { ++frees; --live; }
+    void onAllocateFailed() { ++failedAllocations; }
+    void onReset() { frees += live; live = 0; }
+    void onSearch(ListStats::Search kind, long long links) const {
+        ++searches[kind];
+        hops[kind] += links;
+    }
+    void fillPool(PoolStats& s) const {
+        s.allocations = allocations;
+        s.frees = frees;
+        s.failedAllocations = failedAllocations;
+        s.live = live;
+        s.peakLive = peakLive;
+    }
+    void fillList(ListStats& s) const {
+        for (int kind = 0; kind < ListStats::SEARCH_KINDS; ++kind) {
+            s.searches[kind] = searches[kind];
+            s.hops[kind] = hops[kind];
+        }
+    }
+
+    long long allocations, frees, failedAllocations, live, peakLive;
+    mutable long long searches[ListStats::SEARCH_KINDS];
+    mutable long long hops[ListStats::SEARCH_KINDS];
+};
+
+#endif // POOLSTATS_H
@@ -0,0 +1,957 @@
+/*-- UnrolledList.h -------------------------------------------------------
+
+This header file defines the UnrolledList class, an unrolled linked list
+built on NodePool. Each pool node is a block holding up to BLOCK_SIZE
+elements in a small array plus their count, so a walk touches several
+elements per link it follows. A full block is split in two before an
+insert; a block that falls below half full after a delete is merged with
+its successor, or borrows from it when both do not fit in one block.
+BLOCK_SIZE defaults to the number of elements that, after the count in
+front of them, fill a 64-byte cache line (at least four). The pool's
+link is kept outside the block: past it with InterleavedLayout, in a
+separate array with SplitLayout. NUM_NODES bounds the number of blocks, not elements.
+  Basic operations are:
+     Constructor:        Initializes an empty list.
+     Capacity Constructor: Initializes an empty list with a sized pool.
+     Copy Constructor:   Creates a copy of an existing list.
+     Move Constructor:   Takes over the blocks and pool of another list.
+     Assignment Operator:Assigns one list to another.
+     Move Assignment:    Replaces the contents by taking over another list.
+     Destructor:         Cleans up all list resources.
+     isEmpty:            Checks if the list is empty.
+     size:               Returns the number of elements in the list.
+     blocks:             Returns the number of blocks in use.
+     traverse:           Traverses and applies a function to each element.
+     forEach:            Applies an inlinable callable to each element.
+     begin/end:          Forward iterators over the list in order.
+     find:               Finds an element by its value.
+     contains:           Checks if a value is in the list.
+     clear:              Clears the list by deleting all elements.
+     insertFront:        Inserts an element at the front of the list.
+     deleteFront:        Deletes the front element of the list.
+     pushBack:           Inserts an element at the end of the list.
+     insertSorted:       Inserts an element in sorted order.
+     remove:             Removes an element by its value.
+     sortList:           Sorts the list (stable, optional comparator).
+     unique:             Removes duplicate elements from the list.
+     getFreeListHead:    Returns the index of the first free block in the pool.
+     capacity:           Returns the number of blocks the pool can hold.
+     printList:          Prints list contents to std::cout.
+     operator<<:         Prints list contents to any std::ostream.
+-------------------------------------------------------------------------*/
+
+#ifndef UNROLLEDLIST_H
+#define UNROLLEDLIST_H
+
+#include "NodePool.h"
+#include "ListTraits.h"
+#include <functional>
+#include <stdexcept>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+#include <unordered_set>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+// DefaultBlockSize is the number of T that fit in a 64-byte cache line
+// after a block's int count, padded to T's alignment; at least 4
+template<typename T>
+struct DefaultBlockSize {
+    static const size_t HEADER = (sizeof(int) + alignof(T) - 1) / alignof(T) * alignof(T);
+    static const int value = (HEADER + 4 * sizeof(T) > 64) ? 4 : static_cast<int>((64 - HEADER) / sizeof(T));
+};
+
+template<typename T, int NUM_NODES = 2048, int BLOCK_SIZE = DefaultBlockSize<T>::value,
+         typename Layout = InterleavedLayout,
+         typename IndexType = typename SmallestIndex<NUM_NODES>::type>
+class UnrolledList {
+    static_assert(BLOCK_SIZE >= 2, "UnrolledList: BLOCK_SIZE must be at least 2");
+
+public:
+    // Block is the pool element: up to BLOCK_SIZE elements in raw storage
+    struct Block {
+        int count;   // Number of constructed elements, in slots [0, count)
+        alignas(T) unsigned char slots[BLOCK_SIZE][sizeof(T)];  // Raw element storage
+
+        Block() : count(0) {}
+        Block(const Block&) = delete;
+        Block& operator=(const Block&) = delete;
+        ~Block() {
+            for (int i = 0; i < count; ++i)
+                at(i).~T();
+        }
+        T& at(int i) { return *std::launder(reinterpret_cast<T*>(slots[i])); }
+        const T& at(int i) const { return *std::launder(reinterpret_cast<const T*>(slots[i])); }
+    };
+
+    typedef NodePool<Block, NUM_NODES, Layout, IndexType> PoolType;
+    typedef IndexType Index;
+    static const IndexType NULL_VALUE = PoolType::NULL_VALUE;
+
+    /***** Iterator *****/
+    template<bool IsConst>
+    class Iterator {
+    /*----------------------------------------------------------------------
+      Forward iterator over the elements, block by block. block() and
+      offset() report the current position. A non-const iterator converts
+      to a const one.
+    ----------------------------------------------------------------------*/
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef typename conditional<IsConst, const T*, T*>::type pointer;
+        typedef typename conditional<IsConst, const T&, T&>::type reference;
+        typedef typename conditional<IsConst, const PoolType*, PoolType*>::type PoolPointer;
+
+        Iterator() : pool(nullptr), blk(NULL_VALUE), pos(0) {}
+        Iterator(PoolPointer pool, IndexType blk, int pos) : pool(pool), blk(blk), pos(pos) {}
+        template<bool C = IsConst, typename = typename enable_if<C>::type>
+        Iterator(const Iterator<false>& other) : pool(other.pool), blk(other.blk), pos(other.pos) {}
+
+        reference operator*() const { return pool->value(blk).at(pos); }
+        pointer operator->() const { return &pool->value(blk).at(pos); }
+        Iterator& operator++() {
+            if (++pos == pool->value(blk).count) {
+                blk = pool->next(blk);
+                pos = 0;
+            }
+            return *this;
+        }
+        Iterator operator++(int) { Iterator old = *this; ++*this; return old; }
+        IndexType block() const { return blk; }
+        int offset() const { return pos; }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) {
+            return a.blk == b.blk && a.pos == b.pos;
+        }
+        friend bool operator!=(const Iterator& a, const Iterator& b) { return !(a == b); }
+
+    private:
+        template<bool> friend class Iterator;
+
+        PoolPointer pool;  // Pool holding the blocks
+        IndexType blk;     // Current block (NULL_VALUE at end)
+        int pos;           // Offset of the element within the block
+    };
+
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    /***** Function Members ******/
+
+    /***** Constructor *****/
+    UnrolledList();
+    /*----------------------------------------------------------------------
+      Constructor for the UnrolledList class.
+      Precondition:  None
+      Postcondition: A new empty UnrolledList object has been created.
+    ----------------------------------------------------------------------*/
+
+    /***** Capacity Constructor *****/
+    explicit UnrolledList(int initialBlocks, bool growable = false);
+    /*----------------------------------------------------------------------
+      Constructor for a list whose pool holds initialBlocks blocks.
+      Precondition:  0 < initialBlocks <= PoolType::MAX_CAPACITY.
+      Postcondition: A new empty list has been created. If growable is true
+                     the pool extends itself in chunks when full instead of
+                     throwing overflow_error.
+    ----------------------------------------------------------------------*/
+
+    /***** Copy Constructor *****/
+    UnrolledList(const UnrolledList& other);
+    /*----------------------------------------------------------------------
+      Creates a new list as a copy of another list.
+      Precondition:  None
+      Postcondition: The copy owns a pool of the same capacity and growth
+                     mode and holds the same elements, packed into full
+                     blocks.
+    ----------------------------------------------------------------------*/
+
+    /***** Assignment Operator *****/
+    UnrolledList& operator=(const UnrolledList& other);
+    /*----------------------------------------------------------------------
+      Assigns the contents of another list to this list.
+      Precondition:  None
+      Postcondition: This list holds the same elements as other.
+                     Returns a reference to this list.
+    ----------------------------------------------------------------------*/
+
+    /***** Move Constructor *****/
+    UnrolledList(UnrolledList&& other) noexcept;
+    /*----------------------------------------------------------------------
+      Creates a new list by taking over the pool and blocks of other.
+      Precondition:  None
+      Postcondition: other is empty and gets a new pool on its next insert.
+    ----------------------------------------------------------------------*/
+
+    /***** Move Assignment *****/
+    UnrolledList& operator=(UnrolledList&& other) noexcept;
+    /*----------------------------------------------------------------------
+      Replaces the contents of this list by taking over other's pool.
+      Precondition:  None
+      Postcondition: As for the move constructor. Returns *this.
+    ----------------------------------------------------------------------*/
+
+    /***** Destructor *****/
+    ~UnrolledList();
+    /*----------------------------------------------------------------------
+      Destructor for the UnrolledList class.
+      Precondition:  None
+      Postcondition: All elements are destroyed and the pool is released.
+    ----------------------------------------------------------------------*/
+
+    /***** isEmpty *****/
+    bool isEmpty() const;
+    /*----------------------------------------------------------------------
+      Checks if the list is empty.
+      Precondition:  None
+      Postcondition: Returns true if the list is empty, false otherwise.
+    ----------------------------------------------------------------------*/
+
+    /***** size *****/
+    int size() const;
+    /*----------------------------------------------------------------------
+      Returns the number of elements in the list.
+      Precondition:  None
+      Postcondition: Returns the element count in O(1).
+    ----------------------------------------------------------------------*/
+
+    /***** blocks *****/
+    int blocks() const;
+    /*----------------------------------------------------------------------
+      Returns the number of blocks the list occupies.
+      Precondition:  None
+      Postcondition: Returns the block count in O(1).
+    ----------------------------------------------------------------------*/
+
+    /***** traverse *****/
+    void traverse(const function<void(const T&)>& visit) const;
+    /*----------------------------------------------------------------------
+      Traverses the list and applies a function to each element.
+      Precondition:  None
+      Postcondition: The function is applied to each element in order.
+    ----------------------------------------------------------------------*/
+
+    /***** forEach *****/
+    template<typename F>
+    void forEach(F&& visit);
+    template<typename F>
+    void forEach(F&& visit) const;
+    /*----------------------------------------------------------------------
+      Applies visit to each element, one block at a time.
+      Precondition:  visit must not insert into or delete from this list.
+      Postcondition: visit has been called once per element, in order.
+    ----------------------------------------------------------------------*/
+
+    /***** begin / end *****/
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    /*----------------------------------------------------------------------
+      Return iterators to the first element and past the last element.
+      Precondition:  None
+      Postcondition: Any insert or delete invalidates every iterator, since
+                     elements shift within and between blocks.
+    ----------------------------------------------------------------------*/
+
+    /***** find *****/
+    const_iterator find(const T& item) const;
+    iterator find(const T& item);
+    /*----------------------------------------------------------------------
+      Searches for an item in the list.
+      Precondition:  None
+      Postcondition: Returns an iterator to the first element equal to
+                     item, end() if there is none.
+    ----------------------------------------------------------------------*/
+
+    /***** contains *****/
+    bool contains(const T& item) const;
+    /*----------------------------------------------------------------------
+      Checks if an item is in the list.
+      Precondition:  None
+      Postcondition: Returns true if some element equals item.
+    ----------------------------------------------------------------------*/
+
+    /***** clear *****/
+    void clear();
+    /*----------------------------------------------------------------------
+      Removes all elements from the list.
+      Precondition:  None
+      Postcondition: The list is empty and every block is back in the pool.
+    ----------------------------------------------------------------------*/
+
+    /***** insertFront *****/
+    void insertFront(const T& item);
+    void insertFront(T&& item);
+    /*----------------------------------------------------------------------
+      Inserts an item at the front of the list.
+      Precondition:  None
+      Postcondition: The item is the first element. The head block is
+                     split first if it is full.
+    ----------------------------------------------------------------------*/
+
+    /***** deleteFront *****/
+    void deleteFront();
+    /*----------------------------------------------------------------------
+      Deletes the first element of the list.
+      Precondition:  None
+      Postcondition: The first element is destroyed.
+      Throws:        underflow_error on an empty list.
+    ----------------------------------------------------------------------*/
+
+    /***** pushBack *****/
+    void pushBack(const T& item);
+    void pushBack(T&& item);
+    /*----------------------------------------------------------------------
+      Inserts an item at the end of the list in O(1).
+      Precondition:  None
+      Postcondition: The item is the last element.
+    ----------------------------------------------------------------------*/
+
+    /***** insertSorted *****/
+    void insertSorted(const T& item);
+    void insertSorted(T&& item);
+    /*----------------------------------------------------------------------
+      Inserts an item before the first element not less than it.
+      Precondition:  T supports operator<.
+      Postcondition: A sorted list stays sorted. The walk compares only
+                     the last element of each block until it reaches the
+                     target block, then binary-searches inside it.
+    ----------------------------------------------------------------------*/
+
+    /***** remove *****/
+    bool remove(const T& item);
+    /*----------------------------------------------------------------------
+      Removes the first occurrence of an item from the list.
+      Precondition:  None
+      Postcondition: Returns true if item was found and removed, false
+                     otherwise. A block left below half full is merged
+                     with or refilled from its successor.
+    ----------------------------------------------------------------------*/
+
+    /***** sortList *****/
+    void sortList();
+    template<typename Compare>
+    void sortList(Compare comp);
+    /*----------------------------------------------------------------------
+      Sorts the elements in ascending order, or by comp.
+      Precondition:  T supports operator< (or comp is a strict weak
+                     ordering); T is move constructible.
+      Postcondition: The list is sorted stably and packed into full blocks;
+                     surplus blocks are returned to the pool.
+    ----------------------------------------------------------------------*/
+
+    /***** unique *****/
+    void unique();
+    /*----------------------------------------------------------------------
+      Removes duplicate elements, keeping only first occurrences.
+      Precondition:  None
+      Postcondition: The remaining elements keep their order and are packed
+                     towards the front in one pass. Uses a hash set of the
+                     kept elements (O(n)) when std::hash<T> exists, an
+                     ordered set (O(n log n)) when T supports operator<,
+                     otherwise pairwise comparison (O(n^2)).
+    ----------------------------------------------------------------------*/
+
+    /***** getFreeListHead *****/
+    IndexType getFreeListHead() const;
+    /*----------------------------------------------------------------------
+      Returns the index of the next block the pool hands out.
+      Precondition:  None
+      Postcondition: Returns NULL_VALUE if the pool is full.
+    ----------------------------------------------------------------------*/
+
+    /***** capacity *****/
+    int capacity() const;
+    /*----------------------------------------------------------------------
+      Returns the number of blocks the list's pool can currently hold.
+      Precondition:  None
+      Postcondition: Returns the pool capacity in blocks.
+    ----------------------------------------------------------------------*/
+
+    /***** printList *****/
+    void printList() const;
+    /*----------------------------------------------------------------------
+      Prints the list contents to standard output.
+      Precondition:  None
+      Postcondition: List elements and free list head are printed to cout.
+    ----------------------------------------------------------------------*/
+
+private:
+    /***** newBlockAfter *****/
+    IndexType newBlockAfter(IndexType prev);
+    /*----------------------------------------------------------------------
+      Allocates an empty block and links it after prev (at the head when
+      prev is NULL_VALUE).
+      Precondition:  None
+      Postcondition: Returns the new block. A list left without a pool by a
+                     move gets a default pool first.
+    ----------------------------------------------------------------------*/
+
+    /***** unlinkBlock *****/
+    void unlinkBlock(IndexType prev, IndexType blk);
+    /*----------------------------------------------------------------------
+      Unlinks block blk, which follows prev, and returns it to the pool.
+      Precondition:  blk is a block of this list.
+      Postcondition: The elements left in blk are destroyed.
+    ----------------------------------------------------------------------*/
+
+    /***** insertAt *****/
+    void insertAt(IndexType blk, int pos, T&& item);
+    /*----------------------------------------------------------------------
+      Inserts item at offset pos of block blk.
+      Precondition:  0 <= pos <= count of blk.
+      Postcondition: blk was split first if it was full; count is updated.
+    ----------------------------------------------------------------------*/
+
+    /***** eraseAt *****/
+    void eraseAt(IndexType prev, IndexType blk, int pos);
+    /*----------------------------------------------------------------------
+      Destroys the element at offset pos of block blk, which follows prev.
+      Precondition:  0 <= pos < count of blk.
+      Postcondition: An emptied block is released; a block below half full
+                     is merged with or refilled from its successor.
+    ----------------------------------------------------------------------*/
+
+    /***** moveElements *****/
+    static void moveElements(Block& from, int first, int n, Block& to, int at);
+    /*----------------------------------------------------------------------
+      Moves n elements from from[first, first + n) into empty slots of to
+      starting at offset at, destroying the sources.
+      Precondition:  The target slots are free.
+      Postcondition: Counts are not changed; the caller updates them.
+    ----------------------------------------------------------------------*/
+
+    /***** truncateFrom *****/
+    void truncateFrom(IndexType prev, IndexType blk, int pos);
+    /*----------------------------------------------------------------------
+      Drops every element from offset pos of block blk to the end.
+      Precondition:  blk follows prev; 0 <= pos <= count of blk.
+      Postcondition: blk keeps pos elements (it is released if pos is 0)
+                     and the blocks after it are released.
+    ----------------------------------------------------------------------*/
+
+    /***** keepIf *****/
+    template<typename Keep, typename Kept>
+    void keepIf(Keep keep, Kept kept);
+    /*----------------------------------------------------------------------
+      Helper for unique: stable in-place compaction across blocks.
+      Precondition:  keep(element) decides whether an element stays.
+      Postcondition: The kept elements are packed towards the front; kept
+                     was called with the final address of each of them,
+                     which stays put for the rest of the pass.
+    ----------------------------------------------------------------------*/
+
+    /***** packFrom *****/
+    template<typename InputIt>
+    void packFrom(InputIt first, InputIt last);
+    /*----------------------------------------------------------------------
+      Refills the list with [first, last), filling each block completely.
+      Precondition:  The list is empty.
+      Postcondition: The list holds the range in order.
+    ----------------------------------------------------------------------*/
+
+    unique_ptr<PoolType> ownedPool;  // Pool owned by this list
+    PoolType* pool;               // Block pool (null after being moved from)
+    IndexType head;               // Index of the first block
+    IndexType tail;               // Index of the last block
+    int count;                    // Number of elements in the list
+    int blockCount;               // Number of blocks in the list
+};
+
+// Implementation
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+const IndexType UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::NULL_VALUE;
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::UnrolledList()
+    : ownedPool(new PoolType()), pool(ownedPool.get()),
+      head(NULL_VALUE), tail(NULL_VALUE), count(0), blockCount(0) {}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::UnrolledList(int initialBlocks, bool growable)
+    : ownedPool(new PoolType(initialBlocks, growable)), pool(ownedPool.get()),
+      head(NULL_VALUE), tail(NULL_VALUE), count(0), blockCount(0) {}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::UnrolledList(const UnrolledList& other)
+    : ownedPool(other.pool ? new PoolType(other.pool->capacity(), other.pool->isGrowable())
+                           : new PoolType()),
+      pool(ownedPool.get()), head(NULL_VALUE), tail(NULL_VALUE), count(0), blockCount(0) {
+    packFrom(other.begin(), other.end());
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>&
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::operator=(const UnrolledList& other) {
+    if (this != &other) {
+        clear();
+        packFrom(other.begin(), other.end());
+    }
+    return *this;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::UnrolledList(UnrolledList&& other) noexcept
+    : ownedPool(std::move(other.ownedPool)), pool(other.pool), head(other.head),
+      tail(other.tail), count(other.count), blockCount(other.blockCount) {
+    other.pool = nullptr;
+    other.head = other.tail = NULL_VALUE;
+    other.count = other.blockCount = 0;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>&
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::operator=(UnrolledList&& other) noexcept {
+    if (this != &other) {
+        clear();
+        ownedPool = std::move(other.ownedPool);
+        pool = other.pool;
+        head = other.head;
+        tail = other.tail;
+        count = other.count;
+        blockCount = other.blockCount;
+        other.pool = nullptr;
+        other.head = other.tail = NULL_VALUE;
+        other.count = other.blockCount = 0;
+    }
+    return *this;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::~UnrolledList() {
+    clear();
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+bool UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::isEmpty() const {
+    return head == NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+int UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::size() const {
+    return count;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+int UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::blocks() const {
+    return blockCount;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::traverse(const function<void(const T&)>& visit) const {
+    forEach(visit);
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+template<typename F>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::forEach(F&& visit) {
+    for (IndexType blk = head; blk != NULL_VALUE; blk = pool->next(blk)) {
+        Block& b = pool->value(blk);
+        for (int i = 0; i < b.count; ++i)
+            visit(b.at(i));
+    }
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+template<typename F>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::forEach(F&& visit) const {
+    for (IndexType blk = head; blk != NULL_VALUE; blk = pool->next(blk)) {
+        const Block& b = pool->value(blk);
+        for (int i = 0; i < b.count; ++i)
+            visit(b.at(i));
+    }
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+typename UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::iterator
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::begin() {
+    return iterator(pool, head, 0);
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+typename UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::iterator
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::end() {
+    return iterator(pool, NULL_VALUE, 0);
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+typename UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::const_iterator
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::begin() const {
+    return const_iterator(pool, head, 0);
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+typename UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::const_iterator
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::end() const {
+    return const_iterator(pool, NULL_VALUE, 0);
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+typename UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::const_iterator
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::cbegin() const {
+    return begin();
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+typename UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::const_iterator
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::cend() const {
+    return end();
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+typename UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::const_iterator
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::find(const T& item) const {
+    for (IndexType blk = head; blk != NULL_VALUE; blk = pool->next(blk)) {
+        const Block& b = pool->value(blk);
+        for (int i = 0; i < b.count; ++i) {
+            if (b.at(i) == item)
+                return const_iterator(pool, blk, i);
+        }
+    }
+    return end();
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+typename UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::iterator
+UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::find(const T& item) {
+    const_iterator it = static_cast<const UnrolledList*>(this)->find(item);
+    return iterator(pool, it.block(), it.offset());
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+bool UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::contains(const T& item) const {
+    return find(item) != end();
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::clear() {
+    while (head != NULL_VALUE)
+        unlinkBlock(NULL_VALUE, head);
+    count = 0;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::insertFront(const T& item) {
+    insertFront(T(item));
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::insertFront(T&& item) {
+    IndexType blk = (head == NULL_VALUE) ? newBlockAfter(NULL_VALUE) : head;
+    insertAt(blk, 0, std::move(item));
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::deleteFront() {
+    if (isEmpty())
+        throw underflow_error("UnrolledList::deleteFront() on empty list");
+    eraseAt(NULL_VALUE, head, 0);
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::pushBack(const T& item) {
+    pushBack(T(item));
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::pushBack(T&& item) {
+    // Start a new block rather than split a full tail, so appends pack fully
+    IndexType blk = tail;
+    if (blk == NULL_VALUE || pool->value(blk).count == BLOCK_SIZE)
+        blk = newBlockAfter(tail);
+    insertAt(blk, pool->value(blk).count, std::move(item));
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::insertSorted(const T& item) {
+    insertSorted(T(item));
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::insertSorted(T&& item) {
+    if (isEmpty()) {
+        insertAt(newBlockAfter(NULL_VALUE), 0, std::move(item));
+        return;
+    }
+    // Skip whole blocks whose last element is still less than item
+    IndexType blk = head;
+    while (pool->next(blk) != NULL_VALUE) {
+        const Block& b = pool->value(blk);
+        if (!(b.at(b.count - 1) < item))
+            break;
+        blk = pool->next(blk);
+    }
+    Block& b = pool->value(blk);
+    int lo = 0, hi = b.count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (b.at(mid) < item)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    insertAt(blk, lo, std::move(item));
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+bool UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::remove(const T& item) {
+    IndexType prev = NULL_VALUE;
+    for (IndexType blk = head; blk != NULL_VALUE; prev = blk, blk = pool->next(blk)) {
+        const Block& b = pool->value(blk);
+        for (int i = 0; i < b.count; ++i) {
+            if (b.at(i) == item) {
+                eraseAt(prev, blk, i);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::sortList() {
+    sortList(less<T>());
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+template<typename Compare>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::sortList(Compare comp) {
+    if (count < 2)
+        return;
+    // Elements are moved out, sorted contiguously and packed back
+    vector<T> items;
+    items.reserve(count);
+    for (T& item : *this)
+        items.push_back(std::move(item));
+    stable_sort(items.begin(), items.end(), comp);
+    clear();
+    packFrom(make_move_iterator(items.begin()), make_move_iterator(items.end()));
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::unique() {
+    if (count < 2)
+        return;
+
+    if constexpr (IsHashable<T>::value) {
+        struct PtrHash {
+            size_t operator()(const T* p) const { return hash<T>()(*p); }
+        };
+        struct PtrEqual {
+            bool operator()(const T* a, const T* b) const { return *a == *b; }
+        };
+        unordered_set<const T*, PtrHash, PtrEqual> seen;
+        seen.reserve(count);
+        keepIf([&seen](const T& item) { return seen.count(&item) == 0; },
+               [&seen](const T* kept) { seen.insert(kept); });
+    } else if constexpr (IsOrdered<T>::value) {
+        struct PtrLess {
+            bool operator()(const T* a, const T* b) const { return *a < *b; }
+        };
+        set<const T*, PtrLess> seen;
+        keepIf([&seen](const T& item) { return seen.count(&item) == 0; },
+               [&seen](const T* kept) { seen.insert(kept); });
+    } else {
+        vector<const T*> seen;
+        keepIf([&seen](const T& item) {
+                   for (const T* p : seen) {
+                       if (*p == item)
+                           return false;
+                   }
+                   return true;
+               },
+               [&seen](const T* kept) { seen.push_back(kept); });
+    }
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+IndexType UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::getFreeListHead() const {
+    return pool ? pool->getFreeListHead() : NULL_VALUE;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+int UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::capacity() const {
+    return pool ? pool->capacity() : 0;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::printList() const {
+    cout << *this;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+IndexType UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::newBlockAfter(IndexType prev) {
+    if (!pool) {
+        ownedPool.reset(new PoolType());
+        pool = ownedPool.get();
+    }
+    IndexType blk = pool->newNode();
+    if (prev == NULL_VALUE) {
+        pool->next(blk) = head;
+        head = blk;
+    } else {
+        pool->next(blk) = pool->next(prev);
+        pool->next(prev) = blk;
+    }
+    if (pool->next(blk) == NULL_VALUE)
+        tail = blk;
+    ++blockCount;
+    return blk;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::unlinkBlock(IndexType prev, IndexType blk) {
+    IndexType after = pool->next(blk);
+    if (prev == NULL_VALUE)
+        head = after;
+    else
+        pool->next(prev) = after;
+    if (blk == tail)
+        tail = prev;
+    pool->deleteNode(blk);
+    --blockCount;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::insertAt(IndexType blk, int pos, T&& item) {
+    if (pool->value(blk).count == BLOCK_SIZE) {
+        // Split: the upper half moves to a new block after blk
+        IndexType upper = newBlockAfter(blk);
+        Block& full = pool->value(blk);
+        Block& half = pool->value(upper);
+        int keep = BLOCK_SIZE / 2;
+        moveElements(full, keep, BLOCK_SIZE - keep, half, 0);
+        half.count = BLOCK_SIZE - keep;
+        full.count = keep;
+        if (pos > keep) {
+            pos -= keep;
+            blk = upper;
+        }
+    }
+    Block& b = pool->value(blk);
+    for (int i = b.count; i > pos; --i) {
+        ::new (b.slots[i]) T(std::move(b.at(i - 1)));
+        b.at(i - 1).~T();
+    }
+    ::new (b.slots[pos]) T(std::move(item));
+    ++b.count;
+    ++count;
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::eraseAt(IndexType prev, IndexType blk, int pos) {
+    Block& b = pool->value(blk);
+    b.at(pos).~T();
+    for (int i = pos + 1; i < b.count; ++i) {
+        ::new (b.slots[i - 1]) T(std::move(b.at(i)));
+        b.at(i).~T();
+    }
+    --b.count;
+    --count;
+
+    if (b.count == 0) {
+        unlinkBlock(prev, blk);
+        return;
+    }
+    IndexType after = pool->next(blk);
+    if (b.count >= BLOCK_SIZE / 2 || after == NULL_VALUE)
+        return;
+    Block& n = pool->value(after);
+    if (b.count + n.count <= BLOCK_SIZE) {
+        // Merge the successor into this block
+        moveElements(n, 0, n.count, b, b.count);
+        b.count += n.count;
+        n.count = 0;
+        unlinkBlock(blk, after);
+    } else {
+        // Borrow from the successor until this block is half full again
+        int take = BLOCK_SIZE / 2 - b.count;
+        moveElements(n, 0, take, b, b.count);
+        b.count += take;
+        for (int i = take; i < n.count; ++i) {
+            ::new (n.slots[i - take]) T(std::move(n.at(i)));
+            n.at(i).~T();
+        }
+        n.count -= take;
+    }
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::moveElements(Block& from, int first, int n,
+                                                                           Block& to, int at) {
+    for (int i = 0; i < n; ++i) {
+        ::new (to.slots[at + i]) T(std::move(from.at(first + i)));
+        from.at(first + i).~T();
+    }
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::truncateFrom(IndexType prev, IndexType blk, int pos) {
+    while (pool->next(blk) != NULL_VALUE) {
+        count -= pool->value(pool->next(blk)).count;
+        unlinkBlock(blk, pool->next(blk));
+    }
+    Block& b = pool->value(blk);
+    for (int i = pos; i < b.count; ++i)
+        b.at(i).~T();
+    count -= b.count - pos;
+    b.count = pos;
+    if (pos == 0)
+        unlinkBlock(prev, blk);
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+template<typename Keep, typename Kept>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::keepIf(Keep keep, Kept kept) {
+    // The write cursor trails the read cursor over the same slots
+    IndexType writePrev = NULL_VALUE, writeBlk = head;
+    int writePos = 0;
+    for (IndexType blk = head; blk != NULL_VALUE; blk = pool->next(blk)) {
+        Block& b = pool->value(blk);
+        for (int i = 0; i < b.count; ++i) {
+            if (!keep(b.at(i)))
+                continue;
+            T& slot = pool->value(writeBlk).at(writePos);
+            if (&slot != &b.at(i))
+                slot = std::move(b.at(i));
+            kept(&slot);
+            if (++writePos == pool->value(writeBlk).count) {
+                writePrev = writeBlk;
+                writeBlk = pool->next(writeBlk);
+                writePos = 0;
+            }
+        }
+    }
+    if (writeBlk != NULL_VALUE)
+        truncateFrom(writePrev, writeBlk, writePos);
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+template<typename InputIt>
+void UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>::packFrom(InputIt first, InputIt last) {
+    for (; first != last; ++first)
+        pushBack(T(*first));
+}
+
+template<typename T, int NUM_NODES, int BLOCK_SIZE, typename Layout, typename IndexType>
+ostream& operator<<(ostream& os, const UnrolledList<T, NUM_NODES, BLOCK_SIZE, Layout, IndexType>& lst) {
+    for (const T& s : lst)
+        os << s << " ";
+    os << "\nFree-list head index: " << +lst.getFreeListHead() << "\n";
+    return os;
+}
+#endif // UNROLLEDLIST_H
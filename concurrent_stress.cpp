@@ -0,0 +1,334 @@
+/*-- concurrent_stress.cpp -----------------------------------------------
+
+  Stress driver for ConcurrentList. Several threads, each with its own
+  Handle, run a random mix of insertSorted, remove, insertAfter and
+  deleteAfter and log the result of every operation. Keys come from two
+  sets: a small shared set every thread works on, and a private range per
+  thread. Only the owner updates its range, so inside it every result is
+  known in advance (the node after the first copy of a key is the next
+  copy, or the next key of the range) and is checked as it happens;
+  deleteAfter only runs there. Now and then a thread retires nodes through
+  a second Handle that it destroys while the first one is pinned.
+  After the threads join, the logs are replayed and the list must hold,
+  for every key, the successful inserts minus the successful removes. It
+  must be sorted, and no node may be reachable twice. Finally the rest of
+  the pool is allocated; if a node in the list had also been freed, it
+  would be handed out again and the list would lose elements or cycle.
+
+  Build and run under ThreadSanitizer:
+     g++ -std=c++17 -O1 -g -fsanitize=thread -pthread concurrent_stress.cpp -o concurrent_stress
+     ./concurrent_stress [threads] [operations per thread] [rounds]
+  It prints one line per round and exits with a non-zero status on the
+  first failed check.
+-------------------------------------------------------------------------*/
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include "ConcurrentList.h"
+
+using namespace std;
+
+// Item orders and compares by key only; uid tells apart the copies of a key
+struct Item {
+    int key;
+    int uid;
+
+    Item(int key, int uid) : key(key), uid(uid) {}
+    bool operator<(const Item& other) const { return key < other.key; }
+    bool operator==(const Item& other) const { return key == other.key; }
+};
+
+const int CAPACITY = 1 << 16;
+const int SHARED_KEYS = 64;        // Keys 0 .. SHARED_KEYS - 1, used by every thread
+const int PRIVATE_KEYS = 64;       // Keys in each thread's own range
+const int PRIVATE_LIMIT = 256;     // Copies a thread keeps in its range at most
+
+typedef ConcurrentList<Item, CAPACITY> ListType;
+typedef ListType::Handle Handle;
+
+enum Op { INSERT_SORTED, INSERT_AFTER, REMOVE, DELETE_AFTER };
+
+// Record is one logged operation: what it did to which key, and whether it took effect
+struct Record {
+    Op op;
+    int key;
+    bool ok;
+};
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        cerr << "FAILED: " << what << "\n";
+        exit(1);
+    }
+}
+
+// Xorshift generator, one per thread
+struct Random {
+    uint32_t state;
+    explicit Random(uint32_t seed) : state(seed ? seed : 1) {}
+    uint32_t operator()() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+// Worker runs one thread's operations and logs them
+class Worker {
+public:
+    Worker(ListType& list, int id, int operations, uint32_t seed)
+        : log(), sortedViolations(0), list(list), id(id), operations(operations),
+          random(seed), own(PRIVATE_KEYS, 0), seq(0) {}
+
+    void run() {
+        Handle h(list);
+        for (int i = 0; i < operations; ++i) {
+            uint32_t r = random();
+            if (r % 256 == 0)
+                nestedHandle(h);
+            else if (r % 2 == 0)
+                shared(h, r >> 1);
+            else
+                owned(h, r >> 1);
+        }
+    }
+
+    vector<Record> log;       // Every operation, in program order
+    int sortedViolations;     // Concurrent traversals that saw keys out of order
+
+private:
+    int ownKey(int k) const { return SHARED_KEYS + id * PRIVATE_KEYS + k; }
+    int nextUid() { return (id << 24) | (seq++ & 0xFFFFFF); }
+
+    // Shared keys: results depend on the other threads and are only logged
+    void shared(Handle& h, uint32_t r) {
+        int key = static_cast<int>(r % SHARED_KEYS);
+        // Removes outnumber inserts so the copies of a key do not pile up
+        switch ((r / SHARED_KEYS) % 6) {
+            case 0:
+                h.insertSorted(Item(key, nextUid()));
+                log.push_back(Record{INSERT_SORTED, key, true});
+                break;
+            case 1: {
+                Handle::Pin pin(h);
+                ListType::Index pos = h.find(Item(key, 0));
+                if (pos == ListType::NULL_VALUE)
+                    break;
+                // A copy of the key right after a copy keeps the list sorted
+                bool ok = h.insertAfter(pos, Item(key, nextUid())) != ListType::NULL_VALUE;
+                log.push_back(Record{INSERT_AFTER, key, ok});
+                break;
+            }
+            case 2:
+            case 3:
+            case 4:
+                log.push_back(Record{REMOVE, key, h.remove(Item(key, 0))});
+                break;
+            default:
+                traverse(h);
+                break;
+        }
+    }
+
+    // Own keys: nobody else touches them, so every result is predictable
+    void owned(Handle& h, uint32_t r) {
+        int k = static_cast<int>(r % PRIVATE_KEYS);
+        int key = ownKey(k);
+        int total = 0;
+        for (int copies : own)
+            total += copies;
+        switch ((r / PRIVATE_KEYS) % 4) {
+            case 0:
+                if (total >= PRIVATE_LIMIT)
+                    break;
+                h.insertSorted(Item(key, nextUid()));
+                log.push_back(Record{INSERT_SORTED, key, true});
+                ++own[k];
+                break;
+            case 1: {
+                if (own[k] == 0 || total >= PRIVATE_LIMIT)
+                    break;
+                Handle::Pin pin(h);
+                ListType::Index pos = h.find(Item(key, 0));
+                check(pos != ListType::NULL_VALUE, "own key missing before insertAfter");
+                bool ok = h.insertAfter(pos, Item(key, nextUid())) != ListType::NULL_VALUE;
+                check(ok, "insertAfter failed on an own key");
+                log.push_back(Record{INSERT_AFTER, key, ok});
+                ++own[k];
+                break;
+            }
+            case 2: {
+                bool ok = h.remove(Item(key, 0));
+                check(ok == (own[k] > 0), "remove disagrees with the owner's model");
+                log.push_back(Record{REMOVE, key, ok});
+                if (ok)
+                    --own[k];
+                break;
+            }
+            default: {
+                if (own[k] == 0)
+                    break;
+                // The node after the first copy of k is another copy or the next own key
+                int victim = own[k] > 1 ? k : -1;
+                for (int j = k + 1; victim < 0 && j < PRIVATE_KEYS; ++j) {
+                    if (own[j] > 0)
+                        victim = j;
+                }
+                if (victim < 0)
+                    break;   // The next node belongs to another thread
+                Handle::Pin pin(h);
+                ListType::Index pos = h.find(Item(key, 0));
+                check(pos != ListType::NULL_VALUE, "own key missing before deleteAfter");
+                bool ok = h.deleteAfter(pos);
+                check(ok, "deleteAfter failed on an own key");
+                log.push_back(Record{DELETE_AFTER, ownKey(victim), ok});
+                --own[victim];
+                break;
+            }
+        }
+    }
+
+    // A second handle on this thread, destroyed while the first is pinned
+    void nestedHandle(Handle& h) {
+        Handle::Pin pin(h);
+        Handle other(list);
+        for (int i = 0; i <= ListType::RETIRE_BATCH; ++i) {
+            int key = static_cast<int>(random() % SHARED_KEYS);
+            other.insertSorted(Item(key, nextUid()));
+            log.push_back(Record{INSERT_SORTED, key, true});
+            log.push_back(Record{REMOVE, key, other.remove(Item(key, 0))});
+        }
+    }
+
+    void traverse(Handle& h) {
+        int previous = -1;
+        bool sorted = true;
+        h.forEach([&](const Item& item) {
+            if (item.key < previous)
+                sorted = false;
+            previous = item.key;
+        });
+        if (!sorted)
+            ++sortedViolations;
+    }
+
+    ListType& list;
+    int id;
+    int operations;
+    Random random;
+    vector<int> own;          // Copies of each own key in the list
+    int seq;                  // Inserts made so far, for the uids
+};
+
+// Snapshot walks the list from one handle, failing on a cycle
+vector<Item> snapshot(Handle& h) {
+    vector<Item> items;
+    h.forEach([&](const Item& item) {
+        if (static_cast<int>(items.size()) > CAPACITY)
+            throw runtime_error("list walk visits more nodes than the pool holds");
+        items.push_back(item);
+    });
+    return items;
+}
+
+void checkDistinct(const vector<Item>& items) {
+    vector<int> uids;
+    for (const Item& item : items)
+        uids.push_back(item.uid);
+    sort(uids.begin(), uids.end());
+    check(adjacent_find(uids.begin(), uids.end()) == uids.end(), "a node is reachable twice");
+}
+
+void runRound(int threads, int operations, int round) {
+    ListType list(CAPACITY);
+    vector<Worker> workers;
+    workers.reserve(threads);
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back(list, t, operations, 2654435761u * (t + 1) + round);
+    vector<thread> pool;
+    for (Worker& w : workers)
+        pool.emplace_back(&Worker::run, &w);
+    for (thread& th : pool)
+        th.join();
+
+    int keys = SHARED_KEYS + threads * PRIVATE_KEYS;
+    vector<long long> expected(keys, 0);
+    long long applied = 0;
+    for (const Worker& w : workers) {
+        check(w.sortedViolations == 0, "a concurrent traversal saw keys out of order");
+        for (const Record& rec : w.log) {
+            if (!rec.ok)
+                continue;
+            ++applied;
+            if (rec.op == INSERT_SORTED || rec.op == INSERT_AFTER)
+                ++expected[rec.key];
+            else
+                --expected[rec.key];
+        }
+    }
+
+    Handle h(list);
+    vector<Item> items;
+    try {
+        items = snapshot(h);
+    } catch (const runtime_error& e) {
+        check(false, e.what());
+    }
+    vector<long long> found(keys, 0);
+    for (size_t i = 0; i < items.size(); ++i) {
+        check(items[i].key >= 0 && items[i].key < keys, "the list holds a key nobody inserted");
+        check(i == 0 || !(items[i] < items[i - 1]), "the list is not sorted");
+        ++found[items[i].key];
+    }
+    checkDistinct(items);
+    for (int k = 0; k < keys; ++k)
+        check(found[k] == expected[k], "a key's count differs from inserts minus removes");
+
+    // Every free node must be truly free: allocating them all leaves the list intact
+    int filled = 0;
+    try {
+        while (true) {
+            h.insertFront(Item(-1, filled));
+            ++filled;
+        }
+    } catch (const overflow_error&) {
+    }
+    vector<Item> after;
+    try {
+        after = snapshot(h);
+    } catch (const runtime_error& e) {
+        check(false, e.what());
+    }
+    check(after.size() == items.size() + static_cast<size_t>(filled), "filling the pool changed the list");
+    vector<Item> rest(after.begin() + filled, after.end());
+    checkDistinct(rest);
+    for (size_t i = 0; i < items.size(); ++i)
+        check(rest[i].key == items[i].key && rest[i].uid == items[i].uid, "filling the pool changed the list");
+
+    cout << "round " << round << ": " << threads << " threads, " << applied
+         << " operations applied, " << items.size() << " elements, "
+         << filled << " free nodes\n";
+}
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? atoi(argv[1]) : 8;
+    int operations = argc > 2 ? atoi(argv[2]) : 20000;
+    int rounds = argc > 3 ? atoi(argv[3]) : 3;
+    // Each thread may hold two handles, and the checks need one more
+    if (threads < 1 || 2 * threads + 1 > ListType::MAX_THREADS || operations < 0 || rounds < 1) {
+        cerr << "usage: concurrent_stress [threads 1-" << (ListType::MAX_THREADS - 1) / 2
+             << "] [operations per thread] [rounds]\n";
+        return 2;
+    }
+    for (int round = 0; round < rounds; ++round)
+        runRound(threads, operations, round);
+    cout << "ok\n";
+    return 0;
+}
@@ -19,6 +19,7 @@ void printMenu() {
          << "10. Remove by Value\n"
          << "11. Sort List\n"
          << "12. Remove Duplicates (Unique)\n"
+         << "13. Insert Back\n"
          << "0. Exit\n"
          << "Choice: ";
 }
@@ -115,6 +116,13 @@ int main() {
                     cout << lst;
                     break;
 
+                case 13: {
+                    cout << "Enter value to insert at back: ";
+                    string v; getline(cin, v);
+                    lst.pushBack(v);
+                    cout << lst;
+                    break;
+                }
                 case 0:
                     cout << "Exiting.\n";
                     break;